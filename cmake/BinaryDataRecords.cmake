@@ -0,0 +1,38 @@
+# bdc_generate_records(<target> <structure files...>)
+#
+# Adds a target that generates a header with a packed record type for every structure file, named like the file, using
+# bdc-codegen. Headers are regenerated whenever their structure file changes. The directories to include them from are
+# stored in <target>_INCLUDE_DIRS:
+#
+#   bdc_generate_records(game-records files/structureFiles/DBCharData.json)
+#   add_dependencies(game game-records)
+#   target_include_directories(game PRIVATE ${game-records_INCLUDE_DIRS})
+
+set(BDC_RECORD_CODEC_DIR "${CMAKE_CURRENT_LIST_DIR}/../src")
+
+function(bdc_generate_records target)
+  set(outputDir "${CMAKE_CURRENT_BINARY_DIR}/${target}")
+  set(stamps "")
+
+  foreach(structureFile ${ARGN})
+    get_filename_component(name "${structureFile}" NAME_WE)
+    get_filename_component(structurePath "${structureFile}" ABSOLUTE)
+    set(header "${outputDir}/${name}.hpp")
+    set(stamp "${outputDir}/${name}.stamp")
+
+    # unchanged headers keep their time stamp, so the stamp tells that the header is up to date
+    add_custom_command(
+      OUTPUT "${stamp}"
+      BYPRODUCTS "${header}"
+      COMMAND bdc-codegen "${structurePath}" --out "${header}"
+      COMMAND ${CMAKE_COMMAND} -E touch "${stamp}"
+      DEPENDS bdc-codegen "${structurePath}"
+      COMMENT "Generating record type ${name}"
+      VERBATIM
+    )
+    list(APPEND stamps "${stamp}")
+  endforeach()
+
+  add_custom_target(${target} ALL DEPENDS ${stamps})
+  set(${target}_INCLUDE_DIRS "${outputDir}" "${BDC_RECORD_CODEC_DIR}" PARENT_SCOPE)
+endfunction()
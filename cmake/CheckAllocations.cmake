@@ -0,0 +1,35 @@
+# Zero-allocation regression test, run by CTest in builds with BDC_ALLOCATION_STATS: generates files for every
+# structure file in STRUCTURE_DIR with GENERATOR, then unpacks and packs them all with CONVERTER --checkAllocations.
+# The structure files are copied to WORK_DIR, as their paths are relative to the directory they are used from.
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/gameFiles" "${WORK_DIR}/userFiles")
+file(COPY "${STRUCTURE_DIR}/" DESTINATION "${WORK_DIR}/structureFiles")
+
+file(GLOB structureFiles "${WORK_DIR}/structureFiles/*.json")
+foreach(structureFile ${structureFiles})
+  execute_process(
+    COMMAND "${GENERATOR}" "${structureFile}" --rows 1200
+    WORKING_DIRECTORY "${WORK_DIR}"
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "bdc-gen failed for ${structureFile}")
+  endif()
+endforeach()
+
+foreach(direction unpack pack)
+  set(flags --batch --checkAllocations)
+  if (direction STREQUAL "pack")
+    list(APPEND flags --pack)
+  endif()
+
+  execute_process(
+    COMMAND "${CONVERTER}" structureFiles ${flags}
+    WORKING_DIRECTORY "${WORK_DIR}"
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Checking the allocations failed while trying to ${direction} the files.")
+  endif()
+endforeach()
@@ -0,0 +1,182 @@
+#include "AllocationStats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+constexpr std::size_t PHASE_SLOT_COUNT = 32;
+constexpr std::size_t FIELD_TYPE_COUNT = static_cast<std::size_t>(FieldType::DOUBLEARRAY) + 1;
+
+namespace
+{
+    // no allocations in here, they are called from operator new
+    struct AllocationCounter
+    {
+        std::atomic<uint64_t> count   = 0;
+        std::atomic<uint64_t> bytes   = 0;
+        std::atomic<uint64_t> entries = 0;
+
+        void add(std::size_t size)
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            count   = 0;
+            bytes   = 0;
+            entries = 0;
+        }
+    };
+
+    // claimed by the first allocation of a phase, the last slot takes every phase that doesn't fit anymore
+    struct PhaseSlot
+    {
+        std::atomic<const char*> name = nullptr;
+        AllocationCounter counter;
+    };
+
+    std::array<PhaseSlot, PHASE_SLOT_COUNT> phaseSlots;
+    std::array<AllocationCounter, FIELD_TYPE_COUNT> fieldCounters;
+
+    thread_local const char* currentPhase = nullptr;
+    thread_local int32_t currentField     = -1;
+
+    const char* const fieldTypeNames[FIELD_TYPE_COUNT] = {
+        "int8",       "int16",      "int24",       "int32",       "uint8",      "uint16",      "uint24",
+        "uint32",     "hex8",       "hex16",       "hex32",       "float",      "double",      "string",
+        "int24array", "int32array", "uint24array", "uint32array", "floatarray", "doublearray",
+    };
+
+    AllocationCounter& getPhaseCounter(const char* name)
+    {
+        for (std::size_t i = 0; i < PHASE_SLOT_COUNT - 1; i++)
+        {
+            auto& slot    = phaseSlots[i];
+            auto existing = slot.name.load(std::memory_order_acquire);
+            if (!existing && slot.name.compare_exchange_strong(existing, name, std::memory_order_acq_rel))
+                return slot.counter;
+            if (existing == name || std::strcmp(existing, name) == 0) return slot.counter;
+        }
+
+        phaseSlots.back().name = "more phases";
+        return phaseSlots.back().counter;
+    }
+
+    [[maybe_unused]] void countAllocation(std::size_t size)
+    {
+        getPhaseCounter(currentPhase ? currentPhase : "other").add(size);
+        if (currentField >= 0) fieldCounters[currentField].add(size);
+    }
+
+    void writeCounter(std::ostream& stream, const char* name, const AllocationCounter& counter)
+    {
+        auto count   = counter.count.load();
+        auto entries = counter.entries.load();
+
+        stream << "  " << std::left << std::setw(16) << name << std::right << std::setw(12) << count
+               << std::setw(16) << counter.bytes.load();
+        if (entries != 0)
+            stream << std::setw(12) << entries << std::setw(12) << std::fixed << std::setprecision(4)
+                   << static_cast<double>(count) / entries;
+        stream << "\n";
+    }
+} // namespace
+
+#ifdef BDC_ALLOCATION_STATS
+bool isCountingAllocations() { return true; }
+#else
+bool isCountingAllocations() { return false; }
+#endif
+
+void resetAllocationStats()
+{
+    for (auto& slot : phaseSlots)
+    {
+        slot.name = nullptr;
+        slot.counter.reset();
+    }
+    for (auto& counter : fieldCounters)
+        counter.reset();
+}
+
+AllocationCount getPhaseAllocations(const std::string& phase)
+{
+    for (auto& slot : phaseSlots)
+    {
+        auto name = slot.name.load();
+        if (name && phase == name) return { slot.counter.count, slot.counter.bytes, slot.counter.entries };
+    }
+
+    return {};
+}
+
+void writeAllocationStats(std::ostream& stream)
+{
+    stream << "Allocations by phase       count           bytes     entries   per entry\n";
+    for (auto& slot : phaseSlots)
+        if (auto name = slot.name.load()) writeCounter(stream, name, slot.counter);
+
+    stream << "Allocations by field type  count           bytes\n";
+    for (std::size_t i = 0; i < FIELD_TYPE_COUNT; i++)
+        if (fieldCounters[i].count != 0) writeCounter(stream, fieldTypeNames[i], fieldCounters[i]);
+}
+
+#ifdef BDC_ALLOCATION_STATS
+AllocationPhase::AllocationPhase(const char* name)
+    : previous(currentPhase)
+{
+    currentPhase = name;
+}
+
+AllocationPhase::~AllocationPhase() { currentPhase = previous; }
+
+AllocationField::AllocationField(FieldType type)
+    : previous(currentField)
+{
+    currentField = static_cast<int32_t>(type);
+}
+
+AllocationField::~AllocationField() { currentField = previous; }
+
+void countAllocationEntry() { getPhaseCounter(currentPhase ? currentPhase : "other").entries++; }
+
+// replaces the global allocation functions, the array and nothrow forms call these by default
+void* operator new(std::size_t size)
+{
+    countAllocation(size);
+    if (auto pointer = std::malloc(size ? size : 1)) return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    countAllocation(size);
+    auto align = static_cast<std::size_t>(alignment);
+    #ifdef _WIN32
+    if (auto pointer = _aligned_malloc(size ? size : 1, align)) return pointer;
+    #else
+    // aligned_alloc wants a multiple of the alignment
+    if (auto pointer = std::aligned_alloc(align, std::max(align, (size + align - 1) / align * align))) return pointer;
+    #endif
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+    #ifdef _WIN32
+void operator delete(void* pointer, std::align_val_t) noexcept { _aligned_free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { _aligned_free(pointer); }
+    #else
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+    #endif
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Structure.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// entries converted before the steady state, while buffers still grow to the largest entry so far
+constexpr std::size_t ALLOCATION_WARMUP_ENTRIES = 1024;
+
+/*
+ * Counts heap allocations by conversion phase and by the type of the field being converted. Only builds with
+ * BDC_ALLOCATION_STATS replace the global operator new to count them, otherwise the scopes compile to nothing.
+ * Phases and fields are tracked per thread, allocations outside of any phase are counted as "other".
+ */
+struct AllocationCount
+{
+    uint64_t count   = 0;
+    uint64_t bytes   = 0;
+    uint64_t entries = 0; // counted by countAllocationEntry while the phase was active
+};
+
+bool isCountingAllocations();
+void resetAllocationStats();
+
+// summed over all threads, phases are identified by name
+AllocationCount getPhaseAllocations(const std::string& phase);
+void writeAllocationStats(std::ostream& stream);
+
+#ifdef BDC_ALLOCATION_STATS
+class AllocationPhase
+{
+    const char* previous;
+
+public:
+    // the name must outlive the stats, e.g. a string literal
+    explicit AllocationPhase(const char* name);
+    ~AllocationPhase();
+
+    AllocationPhase(const AllocationPhase&)            = delete;
+    AllocationPhase& operator=(const AllocationPhase&) = delete;
+};
+
+class AllocationField
+{
+    int32_t previous;
+
+public:
+    explicit AllocationField(FieldType type);
+    ~AllocationField();
+
+    AllocationField(const AllocationField&)            = delete;
+    AllocationField& operator=(const AllocationField&) = delete;
+};
+
+void countAllocationEntry();
+#else
+class AllocationPhase
+{
+public:
+    explicit AllocationPhase(const char*) {}
+};
+
+class AllocationField
+{
+public:
+    explicit AllocationField(FieldType) {}
+};
+
+inline void countAllocationEntry() {}
+#endif
@@ -1,294 +1,605 @@
 #include "BinaryChannel.hpp"
 
+#include "FileStream.hpp"
+#include "Trace.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <limits>
+#include <utility>
+#include <vector>
 
-/* Binary Reader  */
-BinaryReader::BinaryReader(boost::json::object config)
-{
-    std::string path(config["path"].as_string());
-    std::size_t offset = config["offset"].is_null() ? 0 : config["offset"].as_int64();
-    expectedEntryCount = config["entryCount"].is_null() ? 0 : config["entryCount"].as_int64();
+constexpr std::size_t PREFIX_BLOCK_SIZE = 64 * 1024;
 
-    if (!std::filesystem::exists(path)) throw std::runtime_error("Input file does not exist!");
+/* Encodings */
+template<BinaryFormat format> int32_t loadInt24(const char* bytes)
+{
+    return loadInt24<format.byteOrder, format.int24Encoding>(bytes);
+}
 
-    fileStream = std::ifstream(path, std::ios::in | std::ios::binary);
-    fileStream.seekg(offset);
+template<BinaryFormat format> void storeInt24(int32_t value, char* bytes)
+{
+    storeInt24<format.byteOrder, format.int24Encoding>(value, bytes);
 }
 
-// Read Functions
-int8_t BinaryReader::readInt8()
+template<BinaryFormat format, typename T> T loadFloat(const char* bytes)
 {
-    int8_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    if constexpr (format.floatEncoding == FloatEncoding::DECIMAL24)
+        return decodeDecimal24(loadUInt24<format.byteOrder>(bytes));
+    else
+        return loadValue<format.byteOrder, T>(bytes);
 }
-int16_t BinaryReader::readInt16()
+
+template<BinaryFormat format, typename T> void storeFloat(T value, char* bytes)
 {
-    int16_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    if constexpr (format.floatEncoding == FloatEncoding::DECIMAL24)
+        storeUInt24<format.byteOrder>(encodeDecimal24(static_cast<float>(value)), bytes);
+    else
+        storeValue<format.byteOrder>(value, bytes);
 }
-int32_t BinaryReader::readInt24()
+
+/* Format Selection */
+template<typename T>
+void readEncoding(const boost::json::object& config,
+                  const std::string& key,
+                  std::initializer_list<std::pair<const char*, T>> options,
+                  T& encoding)
 {
-    int32_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), 3);
-    return (val << 8) >> 8;
+    auto value = config.if_contains(key);
+    if (!value || !value->is_string()) return;
+
+    std::string name(value->as_string());
+    for (auto& option : options)
+    {
+        if (boost::algorithm::iequals(name, option.first))
+        {
+            encoding = option.second;
+            return;
+        }
+    }
+
+    throw std::runtime_error("Unknown " + key + ": " + name);
 }
-int32_t BinaryReader::readInt32()
+
+BinaryFormat getBinaryFormat(const boost::json::object& config, BinaryFormat defaults)
 {
-    int32_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    BinaryFormat format = defaults;
+    readEncoding(config, "byteOrder", { { "little", ByteOrder::LITTLE }, { "big", ByteOrder::BIG } }, format.byteOrder);
+    readEncoding(config,
+                 "stringEncoding",
+                 { { "inline", StringEncoding::INLINE }, { "table", StringEncoding::TABLE } },
+                 format.stringEncoding);
+    readEncoding(config,
+                 "floatEncoding",
+                 { { "ieee", FloatEncoding::IEEE }, { "decimal24", FloatEncoding::DECIMAL24 } },
+                 format.floatEncoding);
+    readEncoding(config,
+                 "int24Encoding",
+                 { { "twosComplement", Int24Encoding::TWOS_COMPLEMENT },
+                   { "signMagnitude", Int24Encoding::SIGN_MAGNITUDE } },
+                 format.int24Encoding);
+
+    return format;
 }
 
-uint8_t BinaryReader::readUInt8()
+/* String Tables */
+std::vector<std::string> loadStringTable(const boost::json::object& config, const std::string& textPath)
 {
-    uint8_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    TraceSpan span("load string table", textPath);
+
+    // the table shares the bundle of the game file, but not its compression
+    boost::json::object textConfig;
+    if (auto bundle = config.if_contains("bundle")) textConfig["bundle"] = *bundle;
+
+    if (!inputExists(textConfig, textPath)) throw std::runtime_error("Input file does not exist!");
+
+    auto textBuffer = openInputBuffer(textConfig, textPath, std::ios::in);
+    std::istream textStream(textBuffer.get());
+    textStream.exceptions(std::ios::badbit); // e.g. a corrupt compressed table must not load as a shorter one
+    std::string str;
+    std::getline(textStream, str);
+
+    std::vector<std::string> stringList;
+    boost::algorithm::split(stringList, str, boost::is_any_of(u8","));
+    return stringList;
 }
-uint16_t BinaryReader::readUInt16()
+
+std::unique_ptr<OutputFile> stageStringTable(const std::string& textPath, const std::vector<std::string>& stringList)
 {
-    uint16_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    TraceSpan span("write string table", textPath);
+
+    auto textFile = std::make_unique<OutputFile>(boost::json::object{}, textPath, std::ios::out | std::ios::binary);
+    std::ostream textStream(textFile->get());
+
+    for (auto& str : stringList)
+        textStream << str << ",";
+
+    if (!textStream) throw std::runtime_error("Could not write file: " + textPath);
+    return textFile;
 }
-uint32_t BinaryReader::readUInt24()
+
+std::unique_ptr<OutputFile> stageStringTable(const std::string& textPath, std::string_view text)
 {
-    uint32_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return (val << 8) >> 8;
+    TraceSpan span("write string table", textPath);
+
+    auto textFile = std::make_unique<OutputFile>(boost::json::object{}, textPath, std::ios::out | std::ios::binary);
+    std::ostream textStream(textFile->get());
+    textStream.write(text.data(), text.size());
+
+    if (!textStream) throw std::runtime_error("Could not write file: " + textPath);
+    return textFile;
 }
-uint32_t BinaryReader::readUInt32()
+
+std::size_t getEntrySize(const BinaryFormat& format, const Structure& structure)
 {
-    uint32_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    std::size_t size = 0;
+    for (auto& field : structure.getFields())
+    {
+        auto fieldSize = getEncodedSize(format, field.type);
+        if (fieldSize == 0) return 0;
+        size += fieldSize;
+    }
+
+    return size;
 }
 
-uint8_t BinaryReader::readHex8()
+constexpr auto BINARY_FORMATS = []()
+{
+    std::array<BinaryFormat, 16> formats;
+    std::size_t i = 0;
+
+    for (auto byteOrder : { ByteOrder::LITTLE, ByteOrder::BIG })
+        for (auto stringEncoding : { StringEncoding::INLINE, StringEncoding::TABLE })
+            for (auto floatEncoding : { FloatEncoding::IEEE, FloatEncoding::DECIMAL24 })
+                for (auto int24Encoding : { Int24Encoding::TWOS_COMPLEMENT, Int24Encoding::SIGN_MAGNITUDE })
+                    formats[i++] = BinaryFormat{ byteOrder, stringEncoding, floatEncoding, int24Encoding };
+
+    return formats;
+}();
+
+template<typename Base, template<BinaryFormat> typename Channel, std::size_t... indices>
+std::unique_ptr<Base>
+makeChannel(const BinaryFormat& format, boost::json::object& config, std::index_sequence<indices...>)
 {
-    uint8_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    std::unique_ptr<Base> channel;
+    ((format == BINARY_FORMATS[indices] && (channel = std::make_unique<Channel<BINARY_FORMATS[indices]>>(config))) ||
+     ...);
+
+    return channel;
 }
-uint16_t BinaryReader::readHex16()
+
+std::unique_ptr<Reader> makeBinaryReader(const BinaryFormat& format, boost::json::object config)
 {
-    uint16_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    return makeChannel<Reader, BinaryReader>(format, config, std::make_index_sequence<BINARY_FORMATS.size()>());
 }
-uint32_t BinaryReader::readHex32()
+
+std::unique_ptr<Writer> makeBinaryWriter(const BinaryFormat& format, boost::json::object config)
 {
-    uint32_t val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    return makeChannel<Writer, BinaryWriter>(format, config, std::make_index_sequence<BINARY_FORMATS.size()>());
 }
 
-float BinaryReader::readFloat()
+/* Binary Reader */
+template<BinaryFormat format> BinaryReader<format>::BinaryReader(boost::json::object config)
 {
-    float val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    std::string path(config["path"].as_string());
+    std::string textPath = config["textPath"].is_null() ? "" : std::string(config["textPath"].as_string());
+    std::size_t offset   = config["offset"].is_null() ? 0 : config["offset"].as_int64();
+    expectedEntryCount   = config["entryCount"].is_null() ? 0 : config["entryCount"].as_int64();
+
+    if (!inputExists(config, path)) throw std::runtime_error("Input file does not exist!");
+
+    fileBuffer = openInputBuffer(config, path, std::ios::binary);
+    fileStream.rdbuf(fileBuffer.get());
+    // failed reads of the buffer would otherwise only set badbit, which hasNext takes for the end of the file
+    fileStream.exceptions(std::ios::badbit);
+    fileStream.seekg(offset);
+
+    if (format.stringEncoding == StringEncoding::TABLE && !textPath.empty())
+        stringList = loadStringTable(config, textPath);
 }
-double BinaryReader::readDouble()
+
+template<BinaryFormat format> template<std::size_t size> std::array<char, size> BinaryReader<format>::readBytes()
 {
-    double val;
-    fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return val;
+    std::array<char, size> bytes{};
+    fileStream.read(bytes.data(), size);
+    return bytes;
 }
 
-std::string BinaryReader::readString()
+// contiguous runs are read in one go, arrays stored like in memory don't need any decoding besides the byte order
+template<BinaryFormat format>
+template<std::size_t size, typename T, typename Decode>
+void BinaryReader<format>::readArray(std::pmr::vector<T>& values, int64_t count, Decode decode)
 {
-    std::stringstream sstream;
-    char val;
+    if (count < 0) throw std::runtime_error("Invalid array length: " + std::to_string(count));
 
-    do
+    values.resize(count);
+    if constexpr (size == sizeof(T))
     {
-        fileStream.read(reinterpret_cast<char*>(&val), sizeof(val));
-        sstream << val;
-    } while (val != '\0');
+        fileStream.read(reinterpret_cast<char*>(values.data()), count * size);
+        if constexpr (format.byteOrder != NATIVE_BYTE_ORDER)
+            for (auto& value : values)
+                value = byteswap(value);
+    }
+    else
+    {
+        scratch.resize(count * size);
+        fileStream.read(scratch.data(), scratch.size());
+        for (std::size_t i = 0; i < values.size(); i++)
+            values[i] = decode(scratch.data() + i * size);
+    }
+}
 
-    return sstream.str();
+// Read Functions
+template<BinaryFormat format> int8_t BinaryReader<format>::readInt8()
+{
+    return loadValue<format.byteOrder, int8_t>(readBytes<1>().data());
+}
+template<BinaryFormat format> int16_t BinaryReader<format>::readInt16()
+{
+    return loadValue<format.byteOrder, int16_t>(readBytes<2>().data());
+}
+template<BinaryFormat format> int32_t BinaryReader<format>::readInt24()
+{
+    return loadInt24<format>(readBytes<3>().data());
+}
+template<BinaryFormat format> int32_t BinaryReader<format>::readInt32()
+{
+    return loadValue<format.byteOrder, int32_t>(readBytes<4>().data());
 }
 
-std::vector<int32_t> BinaryReader::readInt24Array()
+template<BinaryFormat format> uint8_t BinaryReader<format>::readUInt8()
+{
+    return loadValue<format.byteOrder, uint8_t>(readBytes<1>().data());
+}
+template<BinaryFormat format> uint16_t BinaryReader<format>::readUInt16()
 {
-    std::vector<int32_t> values;
-    int32_t count = readInt24();
+    return loadValue<format.byteOrder, uint16_t>(readBytes<2>().data());
+}
+template<BinaryFormat format> uint32_t BinaryReader<format>::readUInt24()
+{
+    return loadUInt24<format.byteOrder>(readBytes<3>().data());
+}
+template<BinaryFormat format> uint32_t BinaryReader<format>::readUInt32()
+{
+    return loadValue<format.byteOrder, uint32_t>(readBytes<4>().data());
+}
 
-    for (int32_t i = 0; i < count; i++)
-        values.push_back(readInt24());
+template<BinaryFormat format> uint8_t BinaryReader<format>::readHex8() { return readUInt8(); }
+template<BinaryFormat format> uint16_t BinaryReader<format>::readHex16() { return readUInt16(); }
+template<BinaryFormat format> uint32_t BinaryReader<format>::readHex32() { return readUInt32(); }
 
-    return values;
+template<BinaryFormat format> float BinaryReader<format>::readFloat()
+{
+    return loadFloat<format, float>(readBytes<getEncodedSize(format, FieldType::FLOAT)>().data());
 }
-std::vector<int32_t> BinaryReader::readInt32Array()
+template<BinaryFormat format> double BinaryReader<format>::readDouble()
 {
-    std::vector<int32_t> values;
-    int32_t count = readInt32();
+    return loadFloat<format, double>(readBytes<getEncodedSize(format, FieldType::DOUBLE)>().data());
+}
 
-    for (int32_t i = 0; i < count; i++)
-        values.push_back(readInt32());
+template<BinaryFormat format> void BinaryReader<format>::readString(std::pmr::string& value)
+{
+    if constexpr (format.stringEncoding == StringEncoding::TABLE)
+    {
+        auto index = readUInt16();
+        if (index >= stringList.size())
+            throw std::runtime_error("Invalid string index " + std::to_string(index) + ", the string table has " +
+                                     std::to_string(stringList.size()) + " strings.");
+        value.assign(stringList[index]);
+    }
+    else
+        std::getline(fileStream, value, '\0');
+}
 
-    return values;
+template<BinaryFormat format> void BinaryReader<format>::readInt24Array(std::pmr::vector<int32_t>& values)
+{
+    readArray<3>(values, readInt24(), [](const char* bytes) { return loadInt24<format>(bytes); });
+}
+template<BinaryFormat format> void BinaryReader<format>::readInt32Array(std::pmr::vector<int32_t>& values)
+{
+    readArray<4>(values, readInt32(), [](const char* bytes) { return loadValue<format.byteOrder, int32_t>(bytes); });
+}
+template<BinaryFormat format> void BinaryReader<format>::readUInt24Array(std::pmr::vector<uint32_t>& values)
+{
+    readArray<3>(values, readInt24(), [](const char* bytes) { return loadUInt24<format.byteOrder>(bytes); });
+}
+template<BinaryFormat format> void BinaryReader<format>::readUInt32Array(std::pmr::vector<uint32_t>& values)
+{
+    readArray<4>(values, readInt32(), [](const char* bytes) { return loadValue<format.byteOrder, uint32_t>(bytes); });
+}
+template<BinaryFormat format> void BinaryReader<format>::readFloatArray(std::pmr::vector<float>& values)
+{
+    readArray<getEncodedSize(format, FieldType::FLOAT)>(values,
+                                                        readInt32(),
+                                                        [](const char* bytes)
+                                                        { return loadFloat<format, float>(bytes); });
+}
+template<BinaryFormat format> void BinaryReader<format>::readDoubleArray(std::pmr::vector<double>& values)
+{
+    readArray<getEncodedSize(format, FieldType::DOUBLE)>(values,
+                                                         readInt32(),
+                                                         [](const char* bytes)
+                                                         { return loadFloat<format, double>(bytes); });
 }
-std::vector<uint32_t> BinaryReader::readUInt24Array()
+
+template<BinaryFormat format> bool BinaryReader<format>::hasNext()
 {
-    std::vector<uint32_t> values;
-    uint32_t count = readInt24();
+    fileStream.peek();
+    if (!fileStream || fileStream.eof()) return false;
 
-    for (uint32_t i = 0u; i < count; i++)
-        values.push_back(readUInt24());
+    if (expectedEntryCount != 0) return currentEntryCount++ < expectedEntryCount;
 
-    return values;
+    return true;
 }
-std::vector<uint32_t> BinaryReader::readUInt32Array()
+
+// Random Access Functions
+template<BinaryFormat format> std::size_t BinaryReader<format>::getFieldSize(FieldType type)
 {
-    std::vector<uint32_t> values;
-    int32_t count = readInt32();
+    return getEncodedSize(format, type);
+}
 
-    for (int32_t i = 0; i < count; i++)
-        values.push_back(readUInt32());
+template<BinaryFormat format> void BinaryReader<format>::skip(FieldType type)
+{
+    constexpr auto floatSize  = static_cast<std::streamsize>(getEncodedSize(format, FieldType::FLOAT));
+    constexpr auto doubleSize = static_cast<std::streamsize>(getEncodedSize(format, FieldType::DOUBLE));
 
-    return values;
+    switch (type)
+    {
+        case FieldType::INT24ARRAY:
+        case FieldType::UINT24ARRAY: fileStream.ignore(static_cast<std::streamsize>(readInt24()) * 3); break;
+        case FieldType::INT32ARRAY:
+        case FieldType::UINT32ARRAY: fileStream.ignore(static_cast<std::streamsize>(readInt32()) * 4); break;
+        case FieldType::FLOATARRAY: fileStream.ignore(static_cast<std::streamsize>(readInt32()) * floatSize); break;
+        case FieldType::DOUBLEARRAY: fileStream.ignore(static_cast<std::streamsize>(readInt32()) * doubleSize); break;
+        case FieldType::STRING:
+            if (format.stringEncoding == StringEncoding::INLINE)
+            {
+                fileStream.ignore(std::numeric_limits<std::streamsize>::max(), '\0');
+                break;
+            }
+            [[fallthrough]];
+        default: fileStream.ignore(getFieldSize(type)); break;
+    }
 }
-std::vector<float> BinaryReader::readFloatArray()
-{
-    std::vector<float> values;
-    int32_t count = readInt32();
 
-    for (int32_t i = 0; i < count; i++)
-        values.push_back(readFloat());
+template<BinaryFormat format> std::size_t BinaryReader<format>::getPosition() { return fileStream.tellg(); }
 
-    return values;
+template<BinaryFormat format> void BinaryReader<format>::setPosition(std::size_t position)
+{
+    fileStream.clear();
+    fileStream.seekg(position);
 }
-std::vector<double> BinaryReader::readDoubleArray()
+
+/* Binary Writer */
+template<BinaryFormat format> BinaryWriter<format>::BinaryWriter(boost::json::object config)
 {
-    std::vector<double> values;
-    int32_t count = readInt32();
+    std::string path(config["path"].as_string());
+    std::size_t offset = config["offset"].is_null() ? 0 : config["offset"].as_int64();
+    textPath           = config["textPath"].is_null() ? "" : std::string(config["textPath"].as_string());
+
+    file.emplace(config, path, std::ios::binary);
+    fileStream.rdbuf(file->get());
 
-    for (int32_t i = 0; i < count; i++)
-        values.push_back(readFloat());
+    if (offset == 0 || config["prefixPath"].is_null())
+    {
+        fileStream.seekp(offset);
+        return;
+    }
+
+    // e.g. the header of the file that gets rewritten, which is only replaced once this one is committed
+    std::string prefixPath(config["prefixPath"].as_string());
+    auto prefix = openInputBuffer({}, prefixPath, std::ios::in | std::ios::binary);
+
+    std::vector<char> buffer(std::min<std::size_t>(offset, PREFIX_BLOCK_SIZE));
+    for (std::size_t left = offset; left > 0;)
+    {
+        auto count = static_cast<std::streamsize>(std::min(left, buffer.size()));
+        if (prefix->sgetn(buffer.data(), count) != count)
+            throw std::runtime_error("The file ends before the offset: " + prefixPath);
 
-    return values;
+        write(buffer.data(), count);
+        left -= count;
+    }
 }
 
-bool BinaryReader::hasNext()
+// straight into the buffer, without the sentry of every ostream::write
+template<BinaryFormat format> void BinaryWriter<format>::write(const char* data, std::size_t size)
 {
-    if (!fileStream) return false;
-
-    if (expectedEntryCount != 0) return currentEntryCount++ < expectedEntryCount;
+    auto count = static_cast<std::streamsize>(size);
+    if (file->get()->sputn(data, count) != count) fileStream.setstate(std::ios::badbit);
+}
 
-    return true;
+template<BinaryFormat format>
+template<std::size_t size>
+void BinaryWriter<format>::writeBytes(const std::array<char, size>& bytes)
+{
+    write(bytes.data(), size);
 }
 
-/* Binary Writer */
-BinaryWriter::BinaryWriter(boost::json::object config)
+// arrays stored like in memory are written directly, everything else gets encoded into one contiguous run first
+template<BinaryFormat format>
+template<std::size_t size, typename T, typename Encode>
+void BinaryWriter<format>::writeArray(std::span<const T> values, Encode encode)
 {
-    std::string path(config["path"].as_string());
-    std::size_t offset = config["offset"].is_null() ? 0 : config["offset"].as_int64();
+    if constexpr (size == sizeof(T) && format.byteOrder == NATIVE_BYTE_ORDER)
+        write(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+    else
+    {
+        scratch.resize(values.size() * size);
+        for (std::size_t i = 0; i < values.size(); i++)
+            encode(values[i], scratch.data() + i * size);
 
-    fileStream = std::ofstream(path, std::ios::out | std::ios::binary);
-    fileStream.seekp(offset);
+        write(scratch.data(), scratch.size());
+    }
 }
 
 // Write Functions
-void BinaryWriter::writeInt8(std::string name, int8_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeInt8(std::string_view name, int8_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 1> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeInt16(std::string name, int16_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeInt16(std::string_view name, int16_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 2> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeInt24(std::string name, int32_t value) { fileStream.write(reinterpret_cast<char*>(&value), 3); }
-void BinaryWriter::writeInt32(std::string name, int32_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeInt24(std::string_view name, int32_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 3> bytes;
+    storeInt24<format>(value, bytes.data());
+    writeBytes(bytes);
+}
+template<BinaryFormat format> void BinaryWriter<format>::writeInt32(std::string_view name, int32_t value)
+{
+    std::array<char, 4> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
 
-void BinaryWriter::writeUInt8(std::string name, uint8_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeUInt8(std::string_view name, uint8_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 1> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeUInt16(std::string name, uint16_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeUInt16(std::string_view name, uint16_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 2> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeUInt24(std::string name, uint32_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeUInt24(std::string_view name, uint32_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), 3);
+    std::array<char, 3> bytes;
+    storeUInt24<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeUInt32(std::string name, uint32_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeUInt32(std::string_view name, uint32_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, 4> bytes;
+    storeValue<format.byteOrder>(value, bytes.data());
+    writeBytes(bytes);
 }
 
-void BinaryWriter::writeHex8(std::string name, uint8_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeHex8(std::string_view name, uint8_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    writeUInt8(name, value);
 }
-void BinaryWriter::writeHex16(std::string name, uint16_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeHex16(std::string_view name, uint16_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    writeUInt16(name, value);
 }
-void BinaryWriter::writeHex32(std::string name, uint32_t value)
+template<BinaryFormat format> void BinaryWriter<format>::writeHex32(std::string_view name, uint32_t value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    writeUInt32(name, value);
 }
 
-void BinaryWriter::writeFloat(std::string name, float value)
+template<BinaryFormat format> void BinaryWriter<format>::writeFloat(std::string_view name, float value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, getEncodedSize(format, FieldType::FLOAT)> bytes;
+    storeFloat<format>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeDouble(std::string name, double value)
+template<BinaryFormat format> void BinaryWriter<format>::writeDouble(std::string_view name, double value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), sizeof(value));
+    std::array<char, getEncodedSize(format, FieldType::DOUBLE)> bytes;
+    storeFloat<format>(value, bytes.data());
+    writeBytes(bytes);
 }
-void BinaryWriter::writeString(std::string name, std::string value)
+template<BinaryFormat format> void BinaryWriter<format>::writeString(std::string_view name, std::string_view value)
 {
-    fileStream.write(reinterpret_cast<char*>(&value), value.length());
+    if constexpr (format.stringEncoding == StringEncoding::TABLE)
+    {
+        if (stringCount < STRING_TABLE_CAPACITY)
+        {
+            writeUInt16(name, static_cast<uint16_t>(stringCount++));
+            stringText.append(value);
+            stringText += ',';
+            return;
+        }
+
+        // a full table still takes strings it already holds, tables that fit stay exactly as they were written
+        if (stringIndices.empty())
+        {
+            std::size_t start = 0;
+            for (std::size_t i = 0; i < stringCount; i++)
+            {
+                auto end = stringText.find(',', start);
+                stringIndices.emplace(stringText.substr(start, end - start), static_cast<uint16_t>(i));
+                start = end + 1;
+            }
+        }
+
+        auto existing = stringIndices.find(value);
+        if (existing == stringIndices.end())
+            throw std::runtime_error("The string table is full, it can only hold 65536 different strings.");
+        writeUInt16(name, existing->second);
+    }
+    else
+    {
+        write(value.data(), value.size());
+        write("\0", 1);
+    }
 }
 
-void BinaryWriter::writeInt24Array(std::string name, std::vector<int32_t> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeInt24Array(std::string_view name, std::span<const int32_t> values)
 {
-    writeInt24(name, (int32_t)values.size());
-    for (auto val : values)
-        writeInt24(name, val);
+    writeInt24(name, static_cast<int32_t>(values.size()));
+    writeArray<3>(values, [](int32_t value, char* bytes) { storeInt24<format>(value, bytes); });
 }
-void BinaryWriter::writeInt32Array(std::string name, std::vector<int32_t> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeInt32Array(std::string_view name, std::span<const int32_t> values)
 {
-    writeInt32(name, (int32_t)values.size());
-    for (auto val : values)
-        writeInt32(name, val);
+    writeInt32(name, static_cast<int32_t>(values.size()));
+    writeArray<4>(values, [](int32_t value, char* bytes) { storeValue<format.byteOrder>(value, bytes); });
 }
-void BinaryWriter::writeUInt24Array(std::string name, std::vector<uint32_t> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeUInt24Array(std::string_view name, std::span<const uint32_t> values)
 {
-    writeInt24(name, (int32_t)values.size());
-    for (auto val : values)
-        writeUInt24(name, val);
+    writeInt24(name, static_cast<int32_t>(values.size()));
+    writeArray<3>(values, [](uint32_t value, char* bytes) { storeUInt24<format.byteOrder>(value, bytes); });
 }
-void BinaryWriter::writeUInt32Array(std::string name, std::vector<uint32_t> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeUInt32Array(std::string_view name, std::span<const uint32_t> values)
 {
-    writeInt32(name, (int32_t)values.size());
-    for (auto val : values)
-        writeUInt32(name, val);
+    writeInt32(name, static_cast<int32_t>(values.size()));
+    writeArray<4>(values, [](uint32_t value, char* bytes) { storeValue<format.byteOrder>(value, bytes); });
 }
-void BinaryWriter::writeFloatArray(std::string name, std::vector<float> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeFloatArray(std::string_view name, std::span<const float> values)
 {
-    writeInt32(name, (int32_t)values.size());
-    for (auto val : values)
-        writeFloat(name, val);
+    writeInt32(name, static_cast<int32_t>(values.size()));
+    writeArray<getEncodedSize(format, FieldType::FLOAT)>(values,
+                                                         [](float value, char* bytes)
+                                                         { storeFloat<format>(value, bytes); });
 }
-void BinaryWriter::writeDoubleArray(std::string name, std::vector<double> values)
+template<BinaryFormat format>
+void BinaryWriter<format>::writeDoubleArray(std::string_view name, std::span<const double> values)
 {
-    writeInt32(name, (int32_t)values.size());
-    for (auto val : values)
-        writeDouble(name, val);
+    writeInt32(name, static_cast<int32_t>(values.size()));
+    writeArray<getEncodedSize(format, FieldType::DOUBLE)>(values,
+                                                          [](double value, char* bytes)
+                                                          { storeFloat<format>(value, bytes); });
 }
 
 // Structure Functions
-void BinaryWriter::startFile(boost::json::object structure) {}
-void BinaryWriter::startEntry() {}
-void BinaryWriter::finishEntry() {}
-void BinaryWriter::finishFile() {}
\ No newline at end of file
+template<BinaryFormat format> void BinaryWriter<format>::startFile(boost::json::object structure) {}
+template<BinaryFormat format> void BinaryWriter<format>::startEntry() {}
+template<BinaryFormat format> void BinaryWriter<format>::finishEntry() {}
+template<BinaryFormat format> void BinaryWriter<format>::finishFile()
+{
+    std::unique_ptr<OutputFile> textFile;
+    if (!textPath.empty() && stringCount != 0) textFile = stageStringTable(textPath, stringText);
+
+    if (!fileStream) throw std::runtime_error("Could not write file.");
+    file->commit();
+    if (textFile) textFile->commit();
+}
@@ -1,14 +1,135 @@
 #pragma once
 
+#include "ByteOrder.hpp"
 #include "Channel.hpp"
+#include "FileStream.hpp"
+#include "RecordCodec.hpp"
+#include "Structure.hpp"
+
+#include <array>
+#include <istream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// indices of StringEncoding::TABLE strings are 16 bit
+constexpr std::size_t STRING_TABLE_CAPACITY = 65536;
+
+enum class StringEncoding
+{
+    INLINE, // null-terminated, in place
+    TABLE,  // 16 bit index into a comma separated text file
+};
+
+enum class FloatEncoding
+{
+    IEEE,
+    DECIMAL24, // sign bit, 3 bit decimal shift and 20 bit mantissa
+};
+
+enum class Int24Encoding
+{
+    TWOS_COMPLEMENT,
+    SIGN_MAGNITUDE,
+};
+
+struct BinaryFormat
+{
+    ByteOrder byteOrder           = ByteOrder::LITTLE;
+    StringEncoding stringEncoding = StringEncoding::INLINE;
+    FloatEncoding floatEncoding   = FloatEncoding::IEEE;
+    Int24Encoding int24Encoding   = Int24Encoding::TWOS_COMPLEMENT;
 
-#include <fstream>
+    bool operator==(const BinaryFormat& other) const = default;
+};
+
+constexpr BinaryFormat PLAIN_BINARY_FORMAT{};
+constexpr BinaryFormat SURVIVE_BINARY_FORMAT{
+    ByteOrder::BIG,
+    StringEncoding::TABLE,
+    FloatEncoding::DECIMAL24,
+    Int24Encoding::SIGN_MAGNITUDE,
+};
+
+template<ByteOrder order, Int24Encoding encoding> int32_t loadInt24(const char* bytes)
+{
+    if constexpr (encoding == Int24Encoding::SIGN_MAGNITUDE)
+        return loadField<order, RecordEncoding::INT24_SIGN_MAGNITUDE, int32_t>(bytes);
+    else
+        return loadField<order, RecordEncoding::INT24, int32_t>(bytes);
+}
 
-class BinaryReader : public Reader
+template<ByteOrder order, Int24Encoding encoding> void storeInt24(int32_t value, char* bytes)
 {
-    std::ifstream fileStream;
+    if constexpr (encoding == Int24Encoding::SIGN_MAGNITUDE)
+        storeField<order, RecordEncoding::INT24_SIGN_MAGNITUDE>(value, bytes);
+    else
+        storeField<order, RecordEncoding::INT24>(value, bytes);
+}
+
+// the comma separated text file of StringEncoding::TABLE
+std::vector<std::string> loadStringTable(const boost::json::object& config, const std::string& textPath);
+// written under a temporary name, committed after the game file, so a failed game file keeps the old table
+std::unique_ptr<OutputFile> stageStringTable(const std::string& textPath, const std::vector<std::string>& stringList);
+// the text as is, every string followed by a comma
+std::unique_ptr<OutputFile> stageStringTable(const std::string& textPath, std::string_view text);
+
+// encoded size of a field, 0 for inline strings and arrays, whose size depends on their contents
+constexpr std::size_t getEncodedSize(const BinaryFormat& format, FieldType type)
+{
+    switch (type)
+    {
+        case FieldType::INT8:
+        case FieldType::UINT8:
+        case FieldType::HEX8: return 1;
+        case FieldType::INT16:
+        case FieldType::UINT16:
+        case FieldType::HEX16: return 2;
+        case FieldType::INT24:
+        case FieldType::UINT24: return 3;
+        case FieldType::INT32:
+        case FieldType::UINT32:
+        case FieldType::HEX32: return 4;
+        case FieldType::FLOAT: return format.floatEncoding == FloatEncoding::DECIMAL24 ? 3 : 4;
+        case FieldType::DOUBLE: return format.floatEncoding == FloatEncoding::DECIMAL24 ? 3 : 8;
+        case FieldType::STRING: return format.stringEncoding == StringEncoding::TABLE ? 2 : 0;
+        default: return 0;
+    }
+}
+
+// size of an entry, 0 when it contains strings or arrays of variable size
+std::size_t getEntrySize(const BinaryFormat& format, const Structure& structure);
+
+/*
+ * Starts from the given defaults, each encoding can be overridden by the "byteOrder" (little, big),
+ * "stringEncoding" (inline, table), "floatEncoding" (ieee, decimal24) and "int24Encoding"
+ * (twosComplement, signMagnitude) keys of the channel config.
+ */
+BinaryFormat getBinaryFormat(const boost::json::object& config, BinaryFormat defaults);
+
+std::unique_ptr<Reader> makeBinaryReader(const BinaryFormat& format, boost::json::object config);
+std::unique_ptr<Writer> makeBinaryWriter(const BinaryFormat& format, boost::json::object config);
+
+/*
+ * Binary channel for any combination of encodings. Every combination is its own instantiation, so the encoding
+ * decisions are made at compile time.
+ */
+template<BinaryFormat format> class BinaryReader : public Reader
+{
+    std::vector<std::string> stringList;
+    std::unique_ptr<std::streambuf> fileBuffer;
+    std::istream fileStream{ nullptr };
     std::size_t expectedEntryCount = 0;
     std::size_t currentEntryCount  = 0;
+    std::vector<char> scratch{}; // raw bytes of arrays that need decoding
+
+    template<std::size_t size> std::array<char, size> readBytes();
+    template<std::size_t size, typename T, typename Decode>
+    void readArray(std::pmr::vector<T>& values, int64_t count, Decode decode);
 
 public:
     BinaryReader(boost::json::object config);
@@ -31,54 +152,74 @@ public:
     virtual float readFloat();
     virtual double readDouble();
 
-    virtual std::string readString();
+    virtual void readString(std::pmr::string& value);
 
-    virtual std::vector<int32_t> readInt24Array();
-    virtual std::vector<int32_t> readInt32Array();
-    virtual std::vector<uint32_t> readUInt24Array();
-    virtual std::vector<uint32_t> readUInt32Array();
-    virtual std::vector<float> readFloatArray();
-    virtual std::vector<double> readDoubleArray();
+    virtual void readInt24Array(std::pmr::vector<int32_t>& values);
+    virtual void readInt32Array(std::pmr::vector<int32_t>& values);
+    virtual void readUInt24Array(std::pmr::vector<uint32_t>& values);
+    virtual void readUInt32Array(std::pmr::vector<uint32_t>& values);
+    virtual void readFloatArray(std::pmr::vector<float>& values);
+    virtual void readDoubleArray(std::pmr::vector<double>& values);
 
     virtual bool hasNext();
+
+    // Random Access Functions
+    virtual std::size_t getFieldSize(FieldType type);
+    virtual void skip(FieldType type);
+    virtual std::size_t getPosition();
+    virtual void setPosition(std::size_t position);
 };
 
-class BinaryWriter : public Writer
+/*
+ * Writes into a temporary file that only replaces the target in finishFile, together with the string table.
+ * The bytes before the "offset" are copied from the file at "prefixPath" if given, and left empty otherwise.
+ */
+template<BinaryFormat format> class BinaryWriter : public Writer
 {
-    std::ofstream fileStream;
+    std::string stringText{}; // the string table as written, so strings don't need an allocation each
+    std::size_t stringCount = 0;
+    std::map<std::string, uint16_t, std::less<>> stringIndices{}; // only built once the table is full
+    std::optional<OutputFile> file;
+    std::ostream fileStream{ nullptr };
+    std::string textPath;
+    std::vector<char> scratch{}; // raw bytes of arrays that need encoding
+
+    void write(const char* data, std::size_t size);
+    template<std::size_t size> void writeBytes(const std::array<char, size>& bytes);
+    template<std::size_t size, typename T, typename Encode> void writeArray(std::span<const T> values, Encode encode);
 
 public:
     BinaryWriter(boost::json::object config);
 
     // Write Functions
-    virtual void writeInt8(std::string name, int8_t value);
-    virtual void writeInt16(std::string name, int16_t value);
-    virtual void writeInt24(std::string name, int32_t value);
-    virtual void writeInt32(std::string name, int32_t value);
-
-    virtual void writeUInt8(std::string name, uint8_t value);
-    virtual void writeUInt16(std::string name, uint16_t value);
-    virtual void writeUInt24(std::string name, uint32_t value);
-    virtual void writeUInt32(std::string name, uint32_t value);
-
-    virtual void writeHex8(std::string name, uint8_t value);
-    virtual void writeHex16(std::string name, uint16_t value);
-    virtual void writeHex32(std::string name, uint32_t value);
-
-    virtual void writeFloat(std::string name, float value);
-    virtual void writeDouble(std::string name, double value);
-    virtual void writeString(std::string name, std::string value);
-
-    virtual void writeInt24Array(std::string name, std::vector<int32_t> values);
-    virtual void writeInt32Array(std::string name, std::vector<int32_t> values);
-    virtual void writeUInt24Array(std::string name, std::vector<uint32_t> values);
-    virtual void writeUInt32Array(std::string name, std::vector<uint32_t> values);
-    virtual void writeFloatArray(std::string name, std::vector<float> values);
-    virtual void writeDoubleArray(std::string name, std::vector<double> values);
+    virtual void writeInt8(std::string_view name, int8_t value);
+    virtual void writeInt16(std::string_view name, int16_t value);
+    virtual void writeInt24(std::string_view name, int32_t value);
+    virtual void writeInt32(std::string_view name, int32_t value);
+
+    virtual void writeUInt8(std::string_view name, uint8_t value);
+    virtual void writeUInt16(std::string_view name, uint16_t value);
+    virtual void writeUInt24(std::string_view name, uint32_t value);
+    virtual void writeUInt32(std::string_view name, uint32_t value);
+
+    virtual void writeHex8(std::string_view name, uint8_t value);
+    virtual void writeHex16(std::string_view name, uint16_t value);
+    virtual void writeHex32(std::string_view name, uint32_t value);
+
+    virtual void writeFloat(std::string_view name, float value);
+    virtual void writeDouble(std::string_view name, double value);
+    virtual void writeString(std::string_view name, std::string_view value);
+
+    virtual void writeInt24Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeInt32Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeUInt24Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeUInt32Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeFloatArray(std::string_view name, std::span<const float> values);
+    virtual void writeDoubleArray(std::string_view name, std::span<const double> values);
 
     // Structure Functions
     virtual void startFile(boost::json::object structure);
     virtual void startEntry();
     virtual void finishEntry();
     virtual void finishFile();
-};
\ No newline at end of file
+};
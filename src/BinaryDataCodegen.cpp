@@ -0,0 +1,108 @@
+#include "ChannelFactory.hpp"
+#include "Codegen.hpp"
+#include "FileStream.hpp"
+#include "Structure.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void runProgram(boost::program_options::variables_map& vm)
+{
+    // parse json
+    std::filesystem::path path = vm["file"].as<std::string>();
+
+    if (!std::filesystem::is_regular_file(path)) throw std::runtime_error("Structure file does not exist.");
+
+    std::ifstream structFile(path);
+    std::stringstream contents;
+    contents << structFile.rdbuf();
+    boost::json::value json = boost::json::parse(contents.str());
+    Structure layout(json.at("structure").as_object());
+
+    // records are stored like the game file described by the input section
+    auto format = getChannelBinaryFormat(json.at("input").as_object());
+    if (!format) throw std::runtime_error("The input section doesn't describe a binary game file.");
+
+    auto name   = vm.count("name") ? vm["name"].as<std::string>() : path.stem().string();
+    auto header = generateRecordHeader(name, layout, *format, path.filename().string());
+
+    std::filesystem::path outPath = vm.count("out") ? vm["out"].as<std::string>() : name + ".hpp";
+
+    // unchanged headers are left alone, so nothing including them gets rebuilt
+    if (std::filesystem::is_regular_file(outPath))
+    {
+        std::ifstream existing(outPath, std::ios::binary);
+        std::stringstream existingContents;
+        existingContents << existing.rdbuf();
+        if (existingContents.str() == header) return;
+    }
+
+    if (outPath.has_parent_path()) std::filesystem::create_directories(outPath.parent_path());
+
+    OutputFile file({}, outPath.string(), std::ios::out | std::ios::binary);
+    std::ostream stream(file.get());
+    stream << header;
+
+    if (!stream) throw std::runtime_error("Could not write file: " + outPath.string());
+    file.commit();
+}
+
+int main(int count, char* args[])
+{
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+
+    try
+    {
+        po::positional_options_description pos;
+        po::options_description desc("Usage: bdc-codegen <structurePath> [options]\n\nAllowed Options");
+
+        auto options = desc.add_options();
+        options("help,h", "This text.");
+        options("file,f", po::value<std::string>(), "Path to the structure .json file to use");
+        options("out,o",
+                po::value<std::string>(),
+                "Path of the generated header. When not set it is written as <name>.hpp to the current directory.");
+        options("name,n",
+                po::value<std::string>(),
+                "Name of the generated record type. When not set the name of the structure file is used.");
+
+        pos.add("file", -1);
+
+        po::store(po::command_line_parser(count, args).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!vm.count("file"))
+    {
+        std::cout << "You must specify a file path!" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        runProgram(vm);
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,99 +1,386 @@
 ﻿#include "BinaryDataConverter.hpp"
 
-#include "BinaryChannel.hpp"
+#include "AllocationStats.hpp"
 #include "CSVChannel.hpp"
 #include "Channel.hpp"
+#include "ChannelFactory.hpp"
+#include "CompressedStream.hpp"
+#include "Diff.hpp"
+#include "FileStream.hpp"
+#include "KeyIndex.hpp"
+#include "ParallelUnpack.hpp"
+#include "Pipeline.hpp"
+#include "Profile.hpp"
+#include "Query.hpp"
 #include "ReadWriter.hpp"
-#include "SurviveChannel.hpp"
+#include "RecordIndex.hpp"
+#include "RowArena.hpp"
+#include "Segments.hpp"
+#include "Structure.hpp"
+#include "Table.hpp"
+#include "Trace.hpp"
+#include "Transcode.hpp"
+#include "Transform.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
-#include <parser.hpp>
 
+#include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
 
-using ReadWriterMap = std::map<std::string, std::shared_ptr<ReadWriter>>;
-ReadWriterMap registerReadWriter();
+// steady state entries per allocation below which --checkAllocations fails
+constexpr uint64_t MIN_ENTRIES_PER_ALLOCATION = 100;
 
-ReadWriterMap readWriter = registerReadWriter();
+std::filesystem::path getIndexPath(boost::json::object& config)
+{
+    if (!config["indexPath"].is_null()) return std::string(config["indexPath"].as_string());
+
+    return std::string(config["path"].as_string()) + ".idx";
+}
 
-std::unique_ptr<Reader> readerFactory(boost::json::object config)
+// the path of a game file that record offsets can refer to
+std::string getIndexedPath(boost::json::object& config)
 {
-    std::string format(config["format"].as_string());
-    boost::algorithm::to_lower(format);
+    std::string path(config["path"].as_string());
+
+    if (config.if_contains("bundle"))
+        throw std::runtime_error("Record indices are not supported for files in bundles.");
 
-    if (format.compare("binary") == 0) return std::make_unique<BinaryReader>(config);
-    if (format.compare("csv") == 0) return std::make_unique<CSVReader>(config);
-    if (format.compare("survivebinary") == 0) return std::make_unique<SurviveReader>(config);
+    // record offsets refer to the decompressed data, which can't be seeked in
+    if (getCompression(config, path) != Compression::NONE)
+        throw std::runtime_error("Record indices are not supported for compressed files.");
 
-    return nullptr;
+    return path;
 }
 
-std::unique_ptr<Writer> writerFactory(boost::json::object config)
+FileFingerprint getFingerprint(boost::json::object& config, const Structure& structure)
 {
-    std::string format(config["format"].as_string());
-    boost::algorithm::to_lower(format);
+    std::size_t offset = config["offset"].is_null() ? 0 : config["offset"].as_int64();
+    return fingerprintFile(getIndexedPath(config), structure, offset);
+}
 
-    if (format.compare("binary") == 0) return std::make_unique<BinaryWriter>(config);
-    if (format.compare("csv") == 0) return std::make_unique<CSVWriter>(config);
-    if (format.compare("survivebinary") == 0) return std::make_unique<SurviveWriter>(config);
+RecordIndex getRecordIndex(boost::json::object& config, const Structure& structure, Reader& reader)
+{
+    // fixed-width entries need no sidecar, so the file doesn't get fingerprinted
+    if (auto stride = getStride(reader, structure))
+    {
+        auto fileSize          = std::filesystem::file_size(getIndexedPath(config));
+        std::size_t offset     = config["offset"].is_null() ? 0 : config["offset"].as_int64();
+        std::size_t entryCount = config["entryCount"].is_null() ? 0 : config["entryCount"].as_int64();
+        return RecordIndex::fixed(fileSize, offset, stride, entryCount);
+    }
+
+    auto fingerprint = getFingerprint(config, structure);
+    auto indexPath   = getIndexPath(config);
+    if (auto index = RecordIndex::load(indexPath, fingerprint)) return *index;
 
-    return nullptr;
+    auto index = RecordIndex::scan(reader, structure, fingerprint);
+    index.save(indexPath);
+    return index;
 }
 
-ReadWriterMap registerReadWriter()
+/*
+ * The key field is given by --key, the "keyField" of the input section or is the first field. Its index is stored
+ * next to the game file as <path>.keys, or at the "keyIndexPath" of the input section.
+ */
+std::size_t
+getKeyField(boost::program_options::variables_map& vm, boost::json::object& config, const Structure& structure)
 {
-    ReadWriterMap map;
-    map["int8"]  = std::make_shared<ReadWriteTuple<int8_t>>(&Reader::readInt8, &Writer::writeInt8);
-    map["int16"] = std::make_shared<ReadWriteTuple<int16_t>>(&Reader::readInt16, &Writer::writeInt16);
-    map["int24"] = std::make_shared<ReadWriteTuple<int32_t>>(&Reader::readInt24, &Writer::writeInt24);
-    map["int32"] = std::make_shared<ReadWriteTuple<int32_t>>(&Reader::readInt32, &Writer::writeInt32);
+    if (vm.count("key")) return findField(structure, vm["key"].as<std::string>());
+    if (!config["keyField"].is_null()) return findField(structure, std::string(config["keyField"].as_string()));
+
+    return 0;
+}
 
-    map["uint8"]  = std::make_shared<ReadWriteTuple<uint8_t>>(&Reader::readUInt8, &Writer::writeUInt8);
-    map["uint16"] = std::make_shared<ReadWriteTuple<uint16_t>>(&Reader::readUInt16, &Writer::writeUInt16);
-    map["uint24"] = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readUInt24, &Writer::writeUInt24);
-    map["uint32"] = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readUInt32, &Writer::writeUInt32);
+std::vector<KeyEntry>
+findKey(boost::json::object& config, const Structure& structure, Reader& reader, std::size_t keyField, uint64_t key)
+{
+    auto fingerprint = getFingerprint(config, structure);
+    std::filesystem::path indexPath = config["keyIndexPath"].is_null()
+                                          ? std::string(config["path"].as_string()) + ".keys"
+                                          : std::string(config["keyIndexPath"].as_string());
 
-    map["hex8"]  = std::make_shared<ReadWriteTuple<uint8_t>>(&Reader::readHex8, &Writer::writeHex8);
-    map["hex16"]  = std::make_shared<ReadWriteTuple<uint16_t>>(&Reader::readHex16, &Writer::writeHex16);
-    map["hex32"]  = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readHex32, &Writer::writeHex32);
+    if (auto entries = KeyIndex::find(indexPath, fingerprint, keyField, key)) return *entries;
 
-    map["float"]  = std::make_shared<ReadWriteTuple<float>>(&Reader::readFloat, &Writer::writeFloat);
-    map["double"] = std::make_shared<ReadWriteTuple<double>>(&Reader::readDouble, &Writer::writeDouble);
-    map["string"] = std::make_shared<ReadWriteTuple<std::string>>(&Reader::readString, &Writer::writeString);
+    auto index = KeyIndex::build(reader, structure, keyField, fingerprint);
+    index.save(indexPath);
+    return index.find(key);
+}
 
-    map["int24array"] =
-        std::make_shared<ReadWriteTuple<std::vector<int32_t>>>(&Reader::readInt24Array, &Writer::writeInt24Array);
-    map["int32array"] =
-        std::make_shared<ReadWriteTuple<std::vector<int32_t>>>(&Reader::readInt32Array, &Writer::writeInt32Array);
-    map["uint24array"] =
-        std::make_shared<ReadWriteTuple<std::vector<uint32_t>>>(&Reader::readUInt24Array, &Writer::writeUInt24Array);
-    map["uint32array"] =
-        std::make_shared<ReadWriteTuple<std::vector<uint32_t>>>(&Reader::readUInt32Array, &Writer::writeUInt32Array);
+std::size_t parseEntryNumber(const std::string& value)
+{
+    std::size_t number = 0;
+    auto end           = value.data() + value.size();
+    auto result        = std::from_chars(value.data(), end, number);
+    if (result.ec != std::errc() || result.ptr != end) throw std::runtime_error("Invalid entry number: " + value);
 
-    map["floatarray"] =
-        std::make_shared<ReadWriteTuple<std::vector<float>>>(&Reader::readFloatArray, &Writer::writeFloatArray);
-    map["doublearray"] =
-        std::make_shared<ReadWriteTuple<std::vector<double>>>(&Reader::readDoubleArray, &Writer::writeDoubleArray);
-    return map;
+    return number;
 }
 
-void runProgram(boost::program_options::variables_map& vm)
+std::pair<std::size_t, std::size_t> getEntryRange(boost::program_options::variables_map& vm, std::size_t entryCount)
 {
-    // parse json
-    std::string path = vm["file"].as<std::string>();
+    std::size_t first = 0;
+    std::size_t last  = entryCount;
 
-    if (!std::filesystem::is_regular_file(path)) throw std::runtime_error("Structure file does not exist.");
+    if (vm.count("entry"))
+    {
+        first = vm["entry"].as<std::size_t>();
+        last  = first + 1;
+    }
+    else if (vm.count("range"))
+    {
+        std::string range = vm["range"].as<std::string>();
+        auto separator    = range.find(':');
+        if (separator == std::string::npos) throw std::runtime_error("Invalid range, expected <first>:<last>.");
+
+        if (separator != 0) first = parseEntryNumber(range.substr(0, separator));
+        if (separator + 1 != range.size()) last = parseEntryNumber(range.substr(separator + 1));
+    }
+
+    if ((first >= entryCount && entryCount != 0) || last > entryCount || first > last)
+        throw std::runtime_error("Requested entries are out of range, the file has " + std::to_string(entryCount) +
+                                 " entries.");
+
+    return { first, last };
+}
+
+uint64_t countCSVEntries(const std::string& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    std::vector<char> block(1024 * 1024);
+    uint64_t lines = 0;
+    char last      = '\n';
+
+    while (stream.read(block.data(), block.size()) || stream.gcount() > 0)
+    {
+        auto end = block.begin() + stream.gcount();
+        lines += std::count(block.begin(), end, '\n');
+        last = *(end - 1);
+    }
+
+    if (last != '\n') lines++;
+    return lines > 0 ? lines - 1 : 0; // header
+}
+
+/*
+ * Game files get preallocated before packing, exactly for entries of fixed size and from the size of the user file
+ * otherwise. The writer grows the file when the estimate was too small and truncates it when it was too large.
+ */
+uint64_t estimateGameFileSize(boost::json::object& userConfig,
+                              boost::json::object& gameConfig,
+                              const Structure& structure)
+{
+    std::string path(userConfig["path"].as_string());
+    auto format = getChannelBinaryFormat(gameConfig);
+    if (!format || !std::filesystem::is_regular_file(path) || getCompression(userConfig, path) != Compression::NONE)
+        return 0;
+
+    uint64_t offset = gameConfig["offset"].is_null() ? 0 : gameConfig["offset"].as_int64();
+    auto entrySize  = getEntrySize(*format, structure);
+    bool isCSV      = boost::algorithm::iequals(std::string(userConfig["format"].as_string()), "csv");
+
+    if (entrySize == 0 || !isCSV) return offset + std::filesystem::file_size(path);
+
+    return offset + countCSVEntries(path) * entrySize;
+}
+
+boost::json::value parseJsonFile(const std::string& path)
+{
+    TraceSpan span("parse json", path);
 
     std::ifstream structFile(path);
     std::stringstream contents;
     contents << structFile.rdbuf();
-    boost::json::value json = boost::json::parse(contents.str());
+    return boost::json::parse(contents.str());
+}
+
+/*
+ * Applies a transform spec to the whole game file in memory and writes it back in its own format, so no text gets
+ * formatted or parsed. The result replaces the game file, unless the "output" section of the spec overrides its keys.
+ */
+void transformFile(boost::json::object& input, const Structure& structure, const std::string& specPath)
+{
+    if (!std::filesystem::is_regular_file(specPath)) throw std::runtime_error("Transform file does not exist.");
+
+    auto spec = parseJsonFile(specPath).as_object();
+    Transform transform(spec, structure);
+
+    Table table(structure);
+    {
+        TraceSpan span("load table");
+        auto reader = readerFactory(input, structure);
+        if (!reader) throw std::runtime_error("Unknown input format.");
+        table.load(*reader);
+    }
+
+    {
+        TraceSpan span("transform");
+        transform.apply(table);
+    }
+
+    auto output = input;
+    if (auto target = spec.if_contains("output"))
+        for (auto& entry : target->as_object())
+            output[entry.key()] = entry.value();
+
+    // whatever comes before the table is kept from the file it was read from
+    if (!output["offset"].is_null() && output["offset"].as_int64() != 0)
+    {
+        if (input.if_contains("bundle"))
+            throw std::runtime_error("The bytes before the offset of a file in a bundle can't be written back.");
+        output["prefixPath"] = input["path"];
+    }
+
+    auto format = getChannelBinaryFormat(output);
+    if (format && getEntrySize(*format, structure) != 0)
+    {
+        uint64_t offset    = output["offset"].is_null() ? 0 : output["offset"].as_int64();
+        output["sizeHint"] = offset + table.getRowCount() * getEntrySize(*format, structure);
+    }
+
+    auto writer = writerFactory(output);
+    if (!writer) throw std::runtime_error("Unknown output format.");
+
+    TraceSpan span("store table");
+    table.store(*writer);
+}
+
+/*
+ * Compares two versions of the game file, both read like the input section. Entries are matched by the --key or
+ * "keyField" of the input section when given, by position otherwise. The report is written to --userFile, as JSON
+ * when its name ends in .json, or to the console.
+ */
+void diffFiles(boost::program_options::variables_map& vm, boost::json::object& input, const Structure& structure)
+{
+    auto paths = vm["diff"].as<std::vector<std::string>>();
+    if (paths.size() != 2) throw std::runtime_error("--diff expects the old and the new game file.");
+
+    std::vector<std::string> textPaths;
+    if (vm.count("diffText")) textPaths = vm["diffText"].as<std::vector<std::string>>();
+    if (!textPaths.empty() && textPaths.size() != 2)
+        throw std::runtime_error("--diffText expects the string tables of the old and the new game file.");
+
+    std::optional<std::size_t> keyField;
+    if (vm.count("key") || !input["keyField"].is_null()) keyField = getKeyField(vm, input, structure);
+
+    auto threadCount = vm.count("threads") ? vm["threads"].as<std::size_t>() : 0;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    auto loadTable = [&](Table& table, std::size_t version)
+    {
+        TraceSpan span("load table", paths[version]);
+
+        auto config    = input;
+        config["path"] = paths[version];
+        if (!textPaths.empty()) config["textPath"] = textPaths[version];
+
+        auto reader = readerFactory(config, structure);
+        if (!reader) throw std::runtime_error("Unknown input format.");
+        table.load(*reader);
+    };
+
+    // both versions get decoded at the same time
+    Table oldTable(structure);
+    Table newTable(structure);
+    auto loadingOld = std::async(std::launch::async, loadTable, std::ref(oldTable), 0);
+    loadTable(newTable, 1);
+    loadingOld.get();
+
+    auto diff = diffTables(oldTable, newTable, keyField, threadCount);
+
+    TraceSpan span("write diff");
+    if (!vm.count("userFile"))
+    {
+        writeDiffCSV(std::cout, oldTable, newTable, diff, keyField);
+        return;
+    }
+
+    std::filesystem::path reportPath = vm["userFile"].as<std::string>();
+    boost::json::object config{ { "path", reportPath.string() } };
+    OutputFile file(config, reportPath.string(), std::ios::out);
+    std::ostream stream(file.get());
+
+    // the extension before the one of the compression decides the format
+    if (getCompression(config, reportPath.string()) != Compression::NONE) reportPath = reportPath.stem();
+    if (boost::algorithm::iequals(reportPath.extension().string(), ".json"))
+        writeDiffJson(stream, oldTable, newTable, diff, keyField);
+    else
+        writeDiffCSV(stream, oldTable, newTable, diff, keyField);
+
+    if (!stream) throw std::runtime_error("Could not write file.");
+    file.commit();
+
+    std::cout << diff.removed.size() << " removed, " << diff.added.size() << " added, " << diff.changed.size()
+              << " changed entries." << std::endl;
+}
+
+void profileFile(boost::program_options::variables_map& vm,
+                 const boost::json::object& config,
+                 const Structure& structure)
+{
+    TraceSpan span("profile");
+    auto reader = readerFactory(config, structure);
+    if (!reader) throw std::runtime_error("Unknown input format.");
+    auto profile = profileColumns(*reader, structure);
+
+    auto reportPath = vm["profileColumns"].as<std::string>();
+    if (reportPath == "-")
+    {
+        std::cout << profile << std::endl;
+        return;
+    }
+
+    boost::json::object reportConfig{ { "path", reportPath } };
+    OutputFile file(reportConfig, reportPath, std::ios::out);
+    std::ostream stream(file.get());
+    stream << profile << '\n';
+
+    if (!stream) throw std::runtime_error("Could not write file.");
+    file.commit();
+}
+
+void convertSegments(boost::program_options::variables_map& vm,
+                     boost::json::object& input,
+                     const boost::json::array& segments)
+{
+    if (vm.count("gameFile")) input["path"] = vm["gameFile"].as<std::string>();
+    if (vm.count("io")) input["io"] = vm["io"].as<std::string>();
+
+    auto threadCount = vm.count("threads") ? vm["threads"].as<std::size_t>() : 0;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    if (!vm.count("pack"))
+    {
+        unpackSegments(input, segments, threadCount);
+        return;
+    }
+
+    packSegments(input, segments, threadCount);
+}
+
+void runProgram(boost::program_options::variables_map& vm, const std::string& path)
+{
+    // parse json
+    if (!std::filesystem::is_regular_file(path)) throw std::runtime_error("Structure file does not exist.");
+
+    TraceSpan span("convert", path);
+    AllocationPhase phase("setup");
+    boost::json::value json = parseJsonFile(path);
     auto& input             = json.as_object()["input"].as_object();
+    if (auto segments = json.as_object().if_contains("segments"))
+    {
+        convertSegments(vm, input, segments->as_array());
+        return;
+    }
+
     auto& output            = json.as_object()["output"].as_object();
     auto& structure         = json.at("structure").as_object();
+    Structure layout(structure);
 
     // parse user input
     bool pack = vm.count("pack");
@@ -103,32 +390,260 @@ void runProgram(boost::program_options::variables_map& vm)
     if (vm.count("gameOffset")) input["offset"] = vm["gameOffset"].as<std::int64_t>();
     if (vm.count("gameCount")) input["entryCount"] = vm["gameCount"].as<std::int64_t>();
 
-    if (vm.count("userFile")) output["/output/path"] = vm["userFile"].as<std::string>();
-    if (vm.count("userText")) output["/output/textPath"] = vm["userText"].as<std::string>();
-    if (vm.count("userOffset")) output["/output/offset"] = vm["userOffset"].as<std::int64_t>();
-    if (vm.count("userCount")) output["/input/entryCount"] = vm["userCount"].as<std::int64_t>();
+    if (vm.count("userFile")) output["path"] = vm["userFile"].as<std::string>();
+    if (vm.count("userText")) output["textPath"] = vm["userText"].as<std::string>();
+    if (vm.count("userOffset")) output["offset"] = vm["userOffset"].as<std::int64_t>();
+    if (vm.count("userCount")) output["entryCount"] = vm["userCount"].as<std::int64_t>();
+
+    if (vm.count("io")) input["io"] = output["io"] = vm["io"].as<std::string>();
+    if (vm.count("pipeline")) input["pipeline"] = output["pipeline"] = true;
+    if (vm.count("bundle"))
+    {
+        if (pack) throw std::runtime_error("--bundle is only supported for unpacking.");
+        input["bundle"] = vm["bundle"].as<std::string>();
+    }
+
+    if (vm.count("diff"))
+    {
+        if (pack) throw std::runtime_error("--diff can't be combined with --pack.");
+        diffFiles(vm, input, layout);
+        return;
+    }
+
+    if (vm.count("transform"))
+    {
+        if (pack) throw std::runtime_error("--transform can't be combined with --pack.");
+        transformFile(input, layout, vm["transform"].as<std::string>());
+        return;
+    }
+
+    // statistics of the file that would be read
+    if (vm.count("profileColumns"))
+    {
+        profileFile(vm, pack ? output : input, layout);
+        return;
+    }
+
+    // binary to binary conversions of whole files skip decoding the entries into values
+    auto& from       = pack ? output : input;
+    auto& to         = pack ? input : output;
+    auto fromFormat  = getChannelBinaryFormat(from);
+    auto toFormat    = getChannelBinaryFormat(to);
+    bool isWholeFile = !vm.count("columns") && !vm.count("where") && !vm.count("threads") && !vm.count("entry") &&
+                       !vm.count("range") && !vm.count("lookup") && !vm.count("index");
+    if (vm.count("pipeline") && !isWholeFile)
+        throw std::runtime_error("--pipeline only converts whole files, it can't be combined with --columns, --where, "
+                                 "--threads, --entry, --range, --lookup or --index.");
+    if (fromFormat && toFormat && isWholeFile)
+    {
+        transcodeBinary(layout, *fromFormat, from, *toFormat, to);
+        return;
+    }
+
+    // create reader
+    std::shared_ptr<Reader> inReader = readerFactory(pack ? output : input, layout);
+
+    // only decode and write selected columns and entries, if requested
+    std::optional<Query> query;
+    if (vm.count("columns") || vm.count("where"))
+    {
+        if (pack) throw std::runtime_error("--columns and --where are only supported for unpacking.");
+
+        query.emplace(layout,
+                      vm.count("columns") ? vm["columns"].as<std::string>() : "",
+                      vm.count("where") ? vm["where"].as<std::string>() : "");
+    }
+
+    auto outStructure = query ? query->getStructure() : structure;
+
+    // decode blocks of entries on multiple threads, if requested
+    if (vm.count("threads"))
+    {
+        if (pack) throw std::runtime_error("--threads is only supported for unpacking.");
+
+        std::string format(output["format"].as_string());
+        if (!boost::algorithm::iequals(format, "csv")) throw std::runtime_error("--threads requires a CSV output.");
+
+        auto threadCount = vm["threads"].as<std::size_t>();
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
 
-    // create reader/writer
-    std::shared_ptr<Reader> inReader  = readerFactory(pack ? output : input);
+        auto index         = getRecordIndex(input, layout, *inReader);
+        auto [first, last] = getEntryRange(vm, index.getEntryCount());
+
+        OutputFile outFile(output, std::string(output["path"].as_string()), std::ios::out);
+        std::ostream outStream(outFile.get());
+        CSVWriter(outStream).startFile(outStructure);
+        unpackParallel(input, outStream, layout, query, index, first, last, threadCount);
+
+        if (!outStream) throw std::runtime_error("Could not write file.");
+        outFile.commit();
+        return;
+    }
+
+    // create writer
+    if (pack) input["sizeHint"] = estimateGameFileSize(output, input, layout);
     std::shared_ptr<Writer> outWriter = writerFactory(pack ? input : output);
 
-    // write file
-    outWriter->startFile(structure);
-    while (inReader->hasNext())
+    // strings and arrays of an entry only live until it has been written
+    RowArena arena;
+
+    auto convert = [&]()
     {
-        outWriter->startEntry();
+        if (query)
+            query->convertEntry(*inReader, *outWriter);
+        else
+            convertEntry(layout, *inReader, *outWriter, arena.get());
+
+        arena.reset();
+    };
+
+    // only read the requested entries
+    if (vm.count("entry") || vm.count("range"))
+    {
+        if (pack) throw std::runtime_error("--entry and --range are only supported for unpacking.");
+
+        auto index         = getRecordIndex(input, layout, *inReader);
+        auto [first, last] = getEntryRange(vm, index.getEntryCount());
+
+        outWriter->startFile(outStructure);
+        inReader->setPosition(index.getOffset(first));
+        for (auto chunk = first; chunk < last; chunk += TRACE_CHUNK_SIZE)
+        {
+            TraceSpan span("entries", std::to_string(chunk));
+            for (auto i = chunk; i < std::min(last, chunk + TRACE_CHUNK_SIZE); i++)
+                convert();
+        }
+        outWriter->finishFile();
+        return;
+    }
+
+    // only read the entries with the requested key
+    if (vm.count("lookup"))
+    {
+        if (pack) throw std::runtime_error("--lookup is only supported for unpacking.");
+
+        auto keyField = getKeyField(vm, input, layout);
+        auto& field   = layout.getFields()[keyField];
+        auto key      = vm["lookup"].as<std::string>();
+        auto entries  = findKey(input, layout, *inReader, keyField, parseKey(field, key));
+        removeHashCollisions(entries, *inReader, layout, keyField, key);
+        if (entries.empty()) throw std::runtime_error("No entry with " + field.name + " " + key + ".");
+
+        outWriter->startFile(outStructure);
+        for (auto& entry : entries)
+        {
+            inReader->setPosition(entry.offset);
+            convert();
+        }
+        outWriter->finishFile();
+        return;
+    }
+
+    // record entry offsets while unpacking, if requested
+    std::optional<RecordIndex> index;
+    if (vm.count("index") && !pack && getStride(*inReader, layout) == 0) index.emplace(getFingerprint(input, layout));
+
+    // decode and encode on separate threads, if requested
+    if (vm.count("pipeline"))
+    {
+        outWriter->startFile(outStructure);
+        convertPipelined(layout, *inReader, *outWriter);
+        outWriter->finishFile();
+        return;
+    }
 
-        for (auto a : structure)
+    // write file
+    // hasNext already advances the CSV reader, so it must be called exactly once per entry
+    std::optional<TraceSpan> chunkSpan;
+    std::optional<AllocationPhase> entryPhase;
+    {
+        AllocationPhase phase("startFile");
+        outWriter->startFile(outStructure);
+    }
+    for (std::size_t i = 0; inReader->hasNext(); i++)
+    {
+        if (i % TRACE_CHUNK_SIZE == 0) chunkSpan.emplace("entries", std::to_string(i));
+        if (i == 0) entryPhase.emplace("warm-up");
+        if (i == ALLOCATION_WARMUP_ENTRIES) entryPhase.emplace("entries");
+        if (index)
         {
-            std::string name(a.key());
-            std::string type(a.value().as_string());
-            boost::algorithm::to_lower(type);
-            readWriter[type]->convert(name, inReader, outWriter);
+            auto position = inReader->getPosition();
+            if (position < index->getFingerprint().fileSize) index->addEntry(position);
         }
 
-        outWriter->finishEntry();
+        convert();
+        countAllocationEntry();
     }
+    chunkSpan.reset();
+    entryPhase.reset();
+
+    AllocationPhase finishPhase("finishFile");
     outWriter->finishFile();
+
+    if (index)
+    {
+        index->finish(std::min<uint64_t>(inReader->getPosition(), index->getFingerprint().fileSize));
+        index->save(getIndexPath(input));
+    }
+}
+
+// converts a file, reporting its allocations with --stats, false when --checkAllocations found per entry allocations
+bool convertFile(boost::program_options::variables_map& vm, const std::string& path)
+{
+    if (!vm.count("stats") && !vm.count("checkAllocations"))
+    {
+        runProgram(vm, path);
+        return true;
+    }
+
+    if (!isCountingAllocations())
+        throw std::runtime_error("--stats and --checkAllocations require a build with BDC_ALLOCATION_STATS.");
+
+    resetAllocationStats();
+    runProgram(vm, path);
+    if (vm.count("stats"))
+    {
+        std::cerr << path << "\n";
+        writeAllocationStats(std::cerr);
+    }
+    if (!vm.count("checkAllocations")) return true;
+
+    // amortized growth of buffers is fine, anything close to one allocation per entry is not
+    auto steady   = getPhaseAllocations("entries");
+    bool isPassed = steady.count * MIN_ENTRIES_PER_ALLOCATION <= steady.entries;
+    std::cout << std::filesystem::path(path).filename().string() << ": " << steady.count << " allocations in "
+              << steady.entries << " entries after the first " << ALLOCATION_WARMUP_ENTRIES
+              << (isPassed ? "" : ", allocates per entry") << std::endl;
+
+    return isPassed;
+}
+
+// converts the files of every structure file in a directory, false when a table or an allocation check failed
+bool runBatch(boost::program_options::variables_map& vm, const std::string& path)
+{
+    if (!std::filesystem::is_directory(path)) throw std::runtime_error("Structure directory does not exist.");
+
+    std::vector<std::filesystem::path> structurePaths;
+    for (auto& entry : std::filesystem::directory_iterator(path))
+        if (entry.is_regular_file() && entry.path().extension() == ".json") structurePaths.push_back(entry.path());
+    std::sort(structurePaths.begin(), structurePaths.end());
+
+    // a failing table doesn't stop the others
+    bool isPassed = true;
+    for (auto& structurePath : structurePaths)
+    {
+        try
+        {
+            isPassed &= convertFile(vm, structurePath.string());
+        }
+        catch (std::exception& ex)
+        {
+            std::cout << structurePath.filename().string() << ": " << ex.what() << std::endl;
+            isPassed = false;
+        }
+    }
+
+    return isPassed;
 }
 
 int main(int count, char* args[])
@@ -167,6 +682,79 @@ int main(int count, char* args[])
         options("gameText,gt", po::value<std::string>(), "Overwrites the textPath parameter for the user file.");
         options("userText,ut", po::value<std::string>(), "Overwrites the textPath parameter for the user file.");
         options("pack,p", "Reverses input/output sections, used to re-create game files.");
+        options("index", "Writes a sidecar record index next to the game file while unpacking.");
+        options("entry,e",
+                po::value<std::size_t>(),
+                "Only unpacks the entry with the given number.\n"
+                "Uses the sidecar record index, which gets created when missing or outdated.");
+        options("range,r",
+                po::value<std::string>(),
+                "Only unpacks the entries in the range <first>:<last>, excluding <last>.\n"
+                "Either side may be omitted. Uses the sidecar record index like --entry.");
+        options("lookup,l",
+                po::value<std::string>(),
+                "Only unpacks the entries whose key field has the given value, e.g. an id.\n"
+                "Uses a sidecar key index, which gets created when missing or outdated.");
+        options("key",
+                po::value<std::string>(),
+                "The key field for --lookup and --diff. When not set the \"keyField\" of the input section or the "
+                "first field is used, --diff matches entries by position without either.");
+        options("columns,c",
+                po::value<std::string>(),
+                "Comma separated list of fields to unpack, in the order they should be written.");
+        options("where,w",
+                po::value<std::string>(),
+                "Only unpacks entries matching the condition, e.g. \"hpMax >= 100 && groupId == 3\".\n"
+                "Supports ==, !=, <, <=, >, >= on numeric fields, combined with && and ||.");
+        options("threads,t",
+                po::value<std::size_t>(),
+                "Unpacks blocks of entries on the given number of threads, 0 uses all cores.\n"
+                "Only supported for CSV output. Uses the sidecar record index like --entry.\n"
+                "Also sets the number of threads hashing entries for --diff.");
+        options("diff",
+                po::value<std::vector<std::string>>()->multitoken(),
+                "Compares the two given versions of the game file and reports removed, added and changed entries "
+                "with the old and new value of every changed field.\n"
+                "Written to --userFile as CSV, or as JSON when it ends in .json, and to the console otherwise.");
+        options("diffText",
+                po::value<std::vector<std::string>>()->multitoken(),
+                "The string tables of the two game files given to --diff, when they differ from the textPath.");
+        options("profileColumns",
+                po::value<std::string>(),
+                "Reads the game file, or the user file with --pack, once and writes statistics of every field to the "
+                "given .json, or to the console for \"-\": min/max, zero and distinct counts, histograms, "
+                "string and array lengths and the smallest type holding all values of integer fields.");
+        options("io",
+                po::value<std::string>(),
+                "Selects the I/O backend for both files, either \"std\", \"uring\" or \"mmap\".\n"
+                "By default output files are written through a memory mapping where available.\n"
+                "\"uring\" reads ahead and writes behind using io_uring on Linux and falls back to \"std\" "
+                "when it isn't available.\n"
+                "\"mmap\" reads input files through a read-only memory mapping where available.");
+        options("pipeline",
+                "Converts whole files in stages on separate threads: reading ahead, decoding, encoding and writing "
+                "behind, connected by bounded queues. Speeds up single large files that --threads can't split.");
+        options("bundle,b",
+                po::value<std::string>(),
+                "Reads the game file and its string table from the TextAssets of a UnityFS asset bundle, named like "
+                "the files without extension.");
+        options("transform",
+                po::value<std::string>(),
+                "Applies the steps of the given transform .json to the game file in memory and writes it back in "
+                "its own format, e.g. to scale stats without going through CSV.");
+        options("trace",
+                po::value<std::string>(),
+                "Records where the time is spent into the given file, which can be opened in Perfetto "
+                "(ui.perfetto.dev) or chrome://tracing.");
+        options("stats",
+                "Prints the heap allocations of the conversion by phase and field type to stderr.\n"
+                "Requires a build with BDC_ALLOCATION_STATS.");
+        options("checkAllocations",
+                "Fails when converting allocates per entry once the first entries are done, e.g. together with "
+                "--batch for all structure files. Requires a build with BDC_ALLOCATION_STATS.");
+        options("batch",
+                "Treats the structure path as a directory and converts the files of every structure .json in it, "
+                "e.g. all tables of one bundle.");
 
         pos.add("file", -1);
 
@@ -179,7 +767,7 @@ int main(int count, char* args[])
             return 1;
         }
     }
-    catch (std::runtime_error& e)
+    catch (std::exception& e)
     {
         std::cout << e.what() << std::endl;
         return 1;
@@ -191,13 +779,31 @@ int main(int count, char* args[])
         return 1;
     }
 
+    if (vm.count("trace")) startTrace();
+
+    bool isPassed = true;
     try
     {
-        runProgram(vm);
+        std::string path = vm["file"].as<std::string>();
+        if (vm.count("batch"))
+            isPassed = runBatch(vm, path);
+        else
+            isPassed = convertFile(vm, path);
     }
-    catch (std::runtime_error& ex)
+    catch (std::exception& ex)
     {
         std::cout << ex.what() << std::endl;
+        isPassed = false;
     }
-    return 0;
-}
\ No newline at end of file
+
+    // also written when converting failed, to show where it did
+    try
+    {
+        if (vm.count("trace")) writeTrace(vm["trace"].as<std::string>());
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include "ChannelFactory.hpp"
+#include "Generator.hpp"
+#include "Structure.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+std::pair<std::size_t, std::size_t> parseLengthRange(const std::string& range)
+{
+    auto separator = range.find(':');
+    if (separator == std::string::npos) throw std::runtime_error("Invalid length range, expected <min>:<max>.");
+
+    return { std::stoull(range.substr(0, separator)), std::stoull(range.substr(separator + 1)) };
+}
+
+void runProgram(boost::program_options::variables_map& vm)
+{
+    // parse json
+    std::string path = vm["file"].as<std::string>();
+
+    if (!std::filesystem::is_regular_file(path)) throw std::runtime_error("Structure file does not exist.");
+
+    std::ifstream structFile(path);
+    std::stringstream contents;
+    contents << structFile.rdbuf();
+    boost::json::value json = boost::json::parse(contents.str());
+    auto& structure         = json.at("structure").as_object();
+    Structure layout(structure);
+
+    // the game file is described by the input section, the user file by the output section
+    auto config = json.at(vm.count("csv") ? "output" : "input").as_object();
+
+    if (vm.count("format")) config["format"] = vm["format"].as<std::string>();
+    if (vm.count("out"))
+    {
+        std::filesystem::path outPath = vm["out"].as<std::string>();
+        config["path"]                = outPath.string();
+
+        // keep the string table next to the generated file, named like the ones shipped with the game
+        if (!config["textPath"].is_null())
+            config["textPath"] = (outPath.parent_path() / (outPath.stem().string() + "Text.txt")).string();
+    }
+    if (vm.count("text")) config["textPath"] = vm["text"].as<std::string>();
+    if (vm.count("io")) config["io"] = vm["io"].as<std::string>();
+
+    // parse generator options, fields can override them in the "generator" section of the structure file
+    boost::json::object defaultConfig;
+    defaultConfig["distribution"] = vm["distribution"].as<std::string>();
+    defaultConfig["decimals"]     = vm["decimals"].as<int32_t>();
+    if (vm.count("min")) defaultConfig["min"] = vm["min"].as<double>();
+    if (vm.count("max")) defaultConfig["max"] = vm["max"].as<double>();
+
+    auto [minLength, maxLength] = parseLengthRange(vm["stringLength"].as<std::string>());
+    auto [minSize, maxSize]     = parseLengthRange(vm["arraySize"].as<std::string>());
+    defaultConfig["length"]     = boost::json::array{ minLength, maxLength };
+    defaultConfig["size"]       = boost::json::array{ minSize, maxSize };
+
+    auto defaults = getFieldGenerator(defaultConfig, FieldGenerator{});
+
+    boost::json::object overrides;
+    if (auto generatorConfig = json.as_object().if_contains("generator")) overrides = generatorConfig->as_object();
+
+    DataGenerator generator(layout, overrides, defaults, vm["seed"].as<uint64_t>());
+
+    // string tables only hold so many strings, which applies to user files that get packed into one later as well
+    auto isTable = [](const boost::json::object& section)
+    {
+        auto format = getChannelBinaryFormat(section);
+        return format && format->stringEncoding == StringEncoding::TABLE;
+    };
+    if (isTable(config) || (vm.count("csv") && isTable(json.at("input").as_object())))
+        generator.limitDistinctStrings(STRING_TABLE_CAPACITY);
+
+    // write file, preallocated for the expected size
+    auto rows = vm["rows"].as<std::size_t>();
+    if (auto format = getChannelBinaryFormat(config))
+        config["sizeHint"] = rows * generator.getAverageEntrySize(*format);
+
+    auto writer = writerFactory(config);
+    if (!writer) throw std::runtime_error("Unknown output format.");
+
+    writer->startFile(structure);
+    for (std::size_t i = 0; i < rows; i++)
+        generator.writeEntry(*writer);
+    writer->finishFile();
+}
+
+int main(int count, char* args[])
+{
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+
+    try
+    {
+        po::positional_options_description pos;
+        po::options_description desc("Usage: bdc-gen <structurePath> [options]\n\nAllowed Options");
+
+        auto options = desc.add_options();
+        options("help,h", "This text.");
+        options("file,f", po::value<std::string>(), "Path to the structure .json file to use");
+        options("rows,n", po::value<std::size_t>()->default_value(1000), "Number of entries to generate.");
+        options("seed,s",
+                po::value<uint64_t>()->default_value(0),
+                "Seed of the random numbers, the same seed always generates the same file.");
+        options("csv",
+                "Generates the user file described by the output section instead of the game file described by the "
+                "input section.");
+        options("out,o",
+                po::value<std::string>(),
+                "Overwrites the path of the generated file.\n"
+                "A string table gets written next to it as <name>Text.txt.");
+        options("text,t", po::value<std::string>(), "Overwrites the path of the generated string table.");
+        options("format", po::value<std::string>(), "Overwrites the format of the generated file, e.g. \"binary\".");
+        options("distribution,d",
+                po::value<std::string>()->default_value("uniform"),
+                "Distribution of numbers, either \"uniform\", \"normal\", \"sequential\" or \"zipf\".");
+        options("min", po::value<double>(), "Smallest generated number, defaults to the smallest the type can store.");
+        options("max", po::value<double>(), "Largest generated number, defaults to the largest the type can store.");
+        options("decimals", po::value<int32_t>()->default_value(2), "Decimal places of generated floats.");
+        options("stringLength",
+                po::value<std::string>()->default_value("4:16"),
+                "Length range of generated strings as <min>:<max>.");
+        options("arraySize",
+                po::value<std::string>()->default_value("0:8"),
+                "Element count range of generated arrays as <min>:<max>.");
+        options("io",
+                po::value<std::string>(),
+                "Selects the I/O backend, either \"std\" or \"uring\".\n"
+                "By default the file is written through a memory mapping where available.");
+
+        pos.add("file", -1);
+
+        po::store(po::command_line_parser(count, args).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!vm.count("file"))
+    {
+        std::cout << "You must specify a file path!" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        runProgram(vm);
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
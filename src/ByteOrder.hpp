@@ -0,0 +1,94 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <cstdlib>
+#endif
+
+enum class ByteOrder
+{
+    LITTLE,
+    BIG,
+};
+
+constexpr ByteOrder NATIVE_BYTE_ORDER = std::endian::native == std::endian::big ? ByteOrder::BIG : ByteOrder::LITTLE;
+
+template<typename T> T byteswap(T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    if constexpr (sizeof(T) == 1)
+        return value;
+    else
+    {
+        using Bits =
+            std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+        static_assert(sizeof(Bits) == sizeof(T));
+
+        auto bits = std::bit_cast<Bits>(value);
+#if defined(__cpp_lib_byteswap)
+        bits = std::byteswap(bits);
+#elif defined(_MSC_VER) && !defined(__clang__)
+        if constexpr (sizeof(T) == 2) bits = _byteswap_ushort(bits);
+        if constexpr (sizeof(T) == 4) bits = _byteswap_ulong(bits);
+        if constexpr (sizeof(T) == 8) bits = _byteswap_uint64(bits);
+#else
+        if constexpr (sizeof(T) == 2) bits = __builtin_bswap16(bits);
+        if constexpr (sizeof(T) == 4) bits = __builtin_bswap32(bits);
+        if constexpr (sizeof(T) == 8) bits = __builtin_bswap64(bits);
+#endif
+        return std::bit_cast<T>(bits);
+    }
+}
+
+// converts between native and the given byte order, in either direction
+template<ByteOrder order, typename T> T convertByteOrder(T value)
+{
+    if constexpr (order == NATIVE_BYTE_ORDER)
+        return value;
+    else
+        return byteswap(value);
+}
+
+template<ByteOrder order, typename T> T loadValue(const char* bytes)
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return convertByteOrder<order>(value);
+}
+
+template<ByteOrder order, typename T> void storeValue(T value, char* bytes)
+{
+    value = convertByteOrder<order>(value);
+    std::memcpy(bytes, &value, sizeof(T));
+}
+
+template<ByteOrder order> uint32_t loadUInt24(const char* bytes)
+{
+    auto data = reinterpret_cast<const uint8_t*>(bytes);
+    if constexpr (order == ByteOrder::LITTLE)
+        return data[0] | (data[1] << 8) | (data[2] << 16);
+    else
+        return (data[0] << 16) | (data[1] << 8) | data[2];
+}
+
+template<ByteOrder order> void storeUInt24(uint32_t value, char* bytes)
+{
+    auto data = reinterpret_cast<uint8_t*>(bytes);
+    if constexpr (order == ByteOrder::LITTLE)
+    {
+        data[0] = value & 0xFF;
+        data[1] = (value >> 8) & 0xFF;
+        data[2] = (value >> 16) & 0xFF;
+    }
+    else
+    {
+        data[0] = (value >> 16) & 0xFF;
+        data[1] = (value >> 8) & 0xFF;
+        data[2] = value & 0xFF;
+    }
+}
@@ -1,9 +1,16 @@
 #include "CSVChannel.hpp"
 
-#include <boost/algorithm/string.hpp>
+#include "FileStream.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <string_view>
 
 CSVReader::CSVReader(boost::json::object config)
 {
@@ -11,237 +18,221 @@ CSVReader::CSVReader(boost::json::object config)
 
     if (!std::filesystem::exists(path)) throw std::runtime_error("Input file does not exist!");
 
-    fileStream = std::make_unique<std::ifstream>(path, std::ios::in);
-    parser     = std::make_unique<aria::csv::CsvParser>(*fileStream.get());
-    parser->begin(); // skip header
+    fileBuffer = openInputBuffer(config, path, std::ios::in);
+    scanner.emplace(fileBuffer.get());
+    scanner->next(currentRow); // skip header
 }
 
 CSVWriter::CSVWriter(boost::json::object config)
+    : file(std::in_place, config, std::string(config["path"].as_string()), std::ios::out)
+    , ownedStream(std::make_unique<std::ostream>(file->get()))
+    , fileStream(*ownedStream)
+{
+}
+
+CSVWriter::CSVWriter(std::ostream& stream)
+    : fileStream(stream)
 {
-    std::string path(config["path"].as_string());
-    fileStream = std::ofstream(path, std::ios::out);
 }
 
 int8_t CSVReader::readInt8()
 {
-    std::string string = read();
+    auto& string = read();
     return (int8_t)std::stol(string);
 }
 int16_t CSVReader::readInt16()
 {
-    std::string string = read();
+    auto& string = read();
     return (int16_t)std::stol(string);
 }
 int32_t CSVReader::readInt24()
 {
-    std::string string = read();
+    auto& string = read();
     return (int32_t)((std::stol(string) << 8) >> 8);
 }
 int32_t CSVReader::readInt32()
 {
-    std::string string = read();
+    auto& string = read();
     return (int32_t)std::stol(string);
 }
 
 uint8_t CSVReader::readUInt8()
 {
-    std::string string = read();
+    auto& string = read();
     return (int8_t)std::stoul(string);
 }
 uint16_t CSVReader::readUInt16()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint16_t)std::stoul(string);
 }
 uint32_t CSVReader::readUInt24()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint32_t)((std::stoul(string) << 8) >> 8);
 }
 uint32_t CSVReader::readUInt32()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint32_t)std::stoul(string);
 }
 
 uint8_t CSVReader::readHex8()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint8_t)std::stoul(string, nullptr, 16);
 }
 uint16_t CSVReader::readHex16()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint16_t)std::stoul(string, nullptr, 16);
 }
 uint32_t CSVReader::readHex32()
 {
-    std::string string = read();
+    auto& string = read();
     return (uint32_t)std::stoul(string, nullptr, 16);
 }
 
 float CSVReader::readFloat()
 {
-    std::string string = read();
+    auto& string = read();
     return std::stof(string);
 };
 double CSVReader::readDouble()
 {
-    std::string string = read();
+    auto& string = read();
     return std::stod(string);
 };
 
-std::string CSVReader::readString() { return read(); };
+void CSVReader::readString(std::pmr::string& value) { value.assign(read()); };
 
-std::vector<int32_t> CSVReader::readInt24Array()
+void CSVReader::readInt24Array(std::pmr::vector<int32_t>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<int32_t> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(),
-                   entries.end(),
-                   output.begin(),
-                   [&](std::string& ref) { return (std::stol(ref) << 8) >> 8; });
-
-    return output;
+    readArray<int32_t, int64_t>(values, [](int64_t val) { return (val << 8) >> 8; });
 };
-std::vector<int32_t> CSVReader::readInt32Array()
+void CSVReader::readInt32Array(std::pmr::vector<int32_t>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<int32_t> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(), entries.end(), output.begin(), [&](std::string& ref) { return std::stol(ref); });
-
-    return output;
+    readArray<int32_t, int64_t>(values, [](int64_t val) { return val; });
 };
-std::vector<uint32_t> CSVReader::readUInt24Array()
+void CSVReader::readUInt24Array(std::pmr::vector<uint32_t>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<uint32_t> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(),
-                   entries.end(),
-                   output.begin(),
-                   [&](std::string& ref) { return (std::stoul(ref) << 8) >> 8; });
-
-    return output;
+    readArray<uint32_t, uint64_t>(values, [](uint64_t val) { return (val << 8) >> 8; });
 };
-std::vector<uint32_t> CSVReader::readUInt32Array()
+void CSVReader::readUInt32Array(std::pmr::vector<uint32_t>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<uint32_t> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(), entries.end(), output.begin(), [&](std::string& ref) { return std::stoul(ref); });
-
-    return output;
+    readArray<uint32_t, uint64_t>(values, [](uint64_t val) { return val; });
 };
 
-std::vector<float> CSVReader::readFloatArray()
+void CSVReader::readFloatArray(std::pmr::vector<float>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<float> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(), entries.end(), output.begin(), [&](std::string ref) { return std::stof(ref); });
-
-    return output;
+    readArray<float, float>(values, [](float val) { return val; });
 };
-std::vector<double> CSVReader::readDoubleArray()
+void CSVReader::readDoubleArray(std::pmr::vector<double>& values)
 {
-    std::vector<std::string> entries;
-    std::vector<double> output;
-
-    boost::split(entries, read(), boost::is_any_of(" "));
-    std::transform(entries.begin(), entries.end(), output.begin(), [&](std::string ref) { return std::stod(ref); });
-
-    return output;
+    readArray<double, double>(values, [](double val) { return val; });
 };
 
 bool CSVReader::hasNext()
 {
-    static int count = 0;
-    count++;
-    bool isEmpty  = parser->empty();
-    currentRow    = *parser->begin();
     currentColumn = 0;
-    return !isEmpty;
+    return scanner->next(currentRow);
 }
 
-std::string CSVReader::read() { return currentRow[currentColumn++]; }
+const std::string& CSVReader::read() { return currentRow[currentColumn++]; }
 
-// Write Functions
-void CSVWriter::writeInt8(std::string name, int8_t value) { write((int32_t)value); }
-void CSVWriter::writeInt16(std::string name, int16_t value) { write(value); }
-void CSVWriter::writeInt24(std::string name, int32_t value) { write(value); }
-void CSVWriter::writeInt32(std::string name, int32_t value) { write(value); }
+template<typename T, typename Parsed, typename Transform>
+void CSVReader::readArray(std::pmr::vector<T>& values, Transform transform)
+{
+    values.clear();
+    auto& field = read();
+    auto it     = field.data();
+    auto end    = field.data() + field.size();
 
-void CSVWriter::writeUInt8(std::string name, uint8_t value) { write((uint32_t)value); }
-void CSVWriter::writeUInt16(std::string name, uint16_t value) { write(value); }
-void CSVWriter::writeUInt24(std::string name, uint32_t value) { write(value); }
-void CSVWriter::writeUInt32(std::string name, uint32_t value) { write(value); }
+    while (it != end)
+    {
+        if (*it == ' ')
+        {
+            it++;
+            continue;
+        }
 
-void CSVWriter::writeHex8(std::string name, uint8_t value)
-{
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << static_cast<uint32_t>(value);
-    write(std::quoted(ss.str(), '\"', '\"'));
+        Parsed value;
+        auto result = std::from_chars(it, end, value);
+        if (result.ec != std::errc()) throw std::runtime_error("Invalid array value: " + field);
+
+        values.push_back(static_cast<T>(transform(value)));
+        it = result.ptr;
+    }
 }
-void CSVWriter::writeHex16(std::string name, uint16_t value)
+
+// Random Access Functions
+std::size_t CSVReader::getFieldSize(FieldType type) { return 0; }
+void CSVReader::skip(FieldType type) { currentColumn++; }
+std::size_t CSVReader::getPosition() { throw std::runtime_error("Unimplemented Feature: CSVReader::getPosition"); }
+void CSVReader::setPosition(std::size_t position)
 {
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << static_cast<uint32_t>(value);
-    write(std::quoted(ss.str(), '\"', '\"'));
+    throw std::runtime_error("Unimplemented Feature: CSVReader::setPosition");
 }
-void CSVWriter::writeHex32(std::string name, uint32_t value)
+
+// Write Functions
+void CSVWriter::writeInt8(std::string_view name, int8_t value) { write((int32_t)value); }
+void CSVWriter::writeInt16(std::string_view name, int16_t value) { write(value); }
+void CSVWriter::writeInt24(std::string_view name, int32_t value) { write(value); }
+void CSVWriter::writeInt32(std::string_view name, int32_t value) { write(value); }
+
+void CSVWriter::writeUInt8(std::string_view name, uint8_t value) { write((uint32_t)value); }
+void CSVWriter::writeUInt16(std::string_view name, uint16_t value) { write(value); }
+void CSVWriter::writeUInt24(std::string_view name, uint32_t value) { write(value); }
+void CSVWriter::writeUInt32(std::string_view name, uint32_t value) { write(value); }
+
+void CSVWriter::writeHex8(std::string_view name, uint8_t value) { writeHex(value, 2); }
+void CSVWriter::writeHex16(std::string_view name, uint16_t value) { writeHex(value, 4); }
+void CSVWriter::writeHex32(std::string_view name, uint32_t value) { writeHex(value, 8); }
+
+void CSVWriter::writeFloat(std::string_view name, float value) { write(value); }
+void CSVWriter::writeDouble(std::string_view name, double value) { write(value); }
+// same as std::quoted with '"' as escape character, which formats through a temporary string stream per value
+void CSVWriter::writeString(std::string_view name, std::string_view value)
 {
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << static_cast<uint32_t>(value);
-    write(std::quoted(ss.str(), '\"', '\"'));
-}
+    if (!isFirst)
+        fileStream << ",";
+    else
+        isFirst = false;
 
-void CSVWriter::writeFloat(std::string name, float value) { write(value); }
-void CSVWriter::writeDouble(std::string name, double value) { write(value); }
-void CSVWriter::writeString(std::string name, std::string value) { write(std::quoted(value, '\"', '\"')); }
+    fileStream << '"';
+    for (auto quote = value.find('"'); quote != std::string_view::npos; quote = value.find('"'))
+    {
+        fileStream.write(value.data(), quote + 1);
+        fileStream << '"';
+        value.remove_prefix(quote + 1);
+    }
+    fileStream.write(value.data(), value.size());
+    fileStream << '"';
+}
 
-void CSVWriter::writeInt24Array(std::string name, std::vector<int32_t> values)
+void CSVWriter::writeInt24Array(std::string_view name, std::span<const int32_t> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](int32_t val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
-void CSVWriter::writeInt32Array(std::string name, std::vector<int32_t> values)
+void CSVWriter::writeInt32Array(std::string_view name, std::span<const int32_t> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](int32_t val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
-void CSVWriter::writeUInt24Array(std::string name, std::vector<uint32_t> values)
+void CSVWriter::writeUInt24Array(std::string_view name, std::span<const uint32_t> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](uint32_t val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
-void CSVWriter::writeUInt32Array(std::string name, std::vector<uint32_t> values)
+void CSVWriter::writeUInt32Array(std::string_view name, std::span<const uint32_t> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](uint32_t val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
-void CSVWriter::writeFloatArray(std::string name, std::vector<float> values)
+void CSVWriter::writeFloatArray(std::string_view name, std::span<const float> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](float val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
-void CSVWriter::writeDoubleArray(std::string name, std::vector<double> values)
+void CSVWriter::writeDoubleArray(std::string_view name, std::span<const double> values)
 {
-    std::vector<std::string> strings;
-    std::transform(values.begin(), values.end(), strings.begin(), [=](double val) { return std::to_string(val); });
-    write(boost::algorithm::join(strings, " "));
+    writeArray(values);
 }
 
 // Structure Functions
@@ -256,9 +247,18 @@ void CSVWriter::startEntry() {}
 void CSVWriter::finishEntry()
 {
     isFirst = true;
-    fileStream << std::endl;
+    fileStream << '\n';
+}
+void CSVWriter::finishFile()
+{
+    TraceSpan span("flush");
+    fileStream.flush();
+
+    // streams given by the caller are committed by the caller
+    if (!file) return;
+    if (!fileStream) throw std::runtime_error("Could not write file.");
+    file->commit();
 }
-void CSVWriter::finishFile() {}
 
 template<typename T> void CSVWriter::write(T value)
 {
@@ -268,4 +268,46 @@ template<typename T> void CSVWriter::write(T value)
         isFirst = false;
 
     fileStream << value;
-}
\ No newline at end of file
+}
+void CSVWriter::writeHex(uint32_t value, int32_t width)
+{
+    std::array<char, 8> digits;
+    int32_t length = std::to_chars(digits.data(), digits.data() + digits.size(), value, 16).ptr - digits.data();
+    int32_t zeroes = std::max(width - length, 0);
+
+    std::array<char, 10> buffer;
+    buffer[0] = '"';
+    std::fill_n(buffer.data() + 1, zeroes, '0');
+    std::transform(digits.data(), digits.data() + length, buffer.data() + 1 + zeroes, ::toupper);
+    buffer[1 + zeroes + length] = '"';
+
+    write(std::string_view(buffer.data(), zeroes + length + 2));
+}
+
+// same formatting as std::to_string, without creating a string per value
+template<typename T> void CSVWriter::writeArray(std::span<const T> values)
+{
+    if (!isFirst)
+        fileStream << ",";
+    else
+        isFirst = false;
+
+    // sign, the integer digits of the largest double, the decimal point and 6 decimals
+    std::array<char, std::numeric_limits<double>::max_exponent10 + 9> buffer;
+    auto begin = buffer.data();
+    auto end   = buffer.data() + buffer.size();
+
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point_v<T>)
+            result = std::to_chars(begin, end, values[i], std::chars_format::fixed, 6);
+        else
+            result = std::to_chars(begin, end, values[i]);
+
+        if (result.ec != std::errc()) throw std::runtime_error("Could not format array value.");
+
+        if (i != 0) fileStream << ' ';
+        fileStream.write(begin, result.ptr - begin);
+    }
+}
@@ -1,20 +1,24 @@
 #pragma once
 
+#include "CSVScanner.hpp"
 #include "Channel.hpp"
+#include "FileStream.hpp"
 
-#include <parser.hpp>
-
-#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
 
 class CSVReader : public Reader
 {
 private:
-    std::unique_ptr<aria::csv::CsvParser> parser;
-    std::unique_ptr<std::ifstream> fileStream;
-    std::vector<std::string> currentRow{};
+    std::unique_ptr<std::streambuf> fileBuffer;
+    std::optional<CSVScanner> scanner;
+    std::vector<std::string> currentRow{}; // the strings get reused by the next row
     uint32_t currentColumn = 0;
 
-    std::string read();
+    const std::string& read();
+    template<typename T, typename Parsed, typename Transform>
+    void readArray(std::pmr::vector<T>& values, Transform transform);
 
 public:
     CSVReader(boost::json::object config);
@@ -37,54 +41,65 @@ public:
     virtual float readFloat();
     virtual double readDouble();
 
-    virtual std::string readString();
+    virtual void readString(std::pmr::string& value);
 
-    virtual std::vector<int32_t> readInt24Array();
-    virtual std::vector<int32_t> readInt32Array();
-    virtual std::vector<uint32_t> readUInt24Array();
-    virtual std::vector<uint32_t> readUInt32Array();
-    virtual std::vector<float> readFloatArray();
-    virtual std::vector<double> readDoubleArray();
+    virtual void readInt24Array(std::pmr::vector<int32_t>& values);
+    virtual void readInt32Array(std::pmr::vector<int32_t>& values);
+    virtual void readUInt24Array(std::pmr::vector<uint32_t>& values);
+    virtual void readUInt32Array(std::pmr::vector<uint32_t>& values);
+    virtual void readFloatArray(std::pmr::vector<float>& values);
+    virtual void readDoubleArray(std::pmr::vector<double>& values);
 
     virtual bool hasNext();
+
+    // Random Access Functions
+    virtual std::size_t getFieldSize(FieldType type);
+    virtual void skip(FieldType type);
+    virtual std::size_t getPosition();
+    virtual void setPosition(std::size_t position);
 };
 
 class CSVWriter : public Writer
 {
 private:
-    std::ofstream fileStream;
+    std::optional<OutputFile> file;
+    std::unique_ptr<std::ostream> ownedStream;
+    std::ostream& fileStream;
     bool isFirst = true;
 
     template<typename T> void write(T value);
+    template<typename T> void writeArray(std::span<const T> values);
+    void writeHex(uint32_t value, int32_t width);
 
 public:
     CSVWriter(boost::json::object config);
+    CSVWriter(std::ostream& stream);
 
     // Write Functions
-    virtual void writeInt8(std::string name, int8_t value);
-    virtual void writeInt16(std::string name, int16_t value);
-    virtual void writeInt24(std::string name, int32_t value);
-    virtual void writeInt32(std::string name, int32_t value);
-
-    virtual void writeUInt8(std::string name, uint8_t value);
-    virtual void writeUInt16(std::string name, uint16_t value);
-    virtual void writeUInt24(std::string name, uint32_t value);
-    virtual void writeUInt32(std::string name, uint32_t value);
-
-    virtual void writeHex8(std::string name, uint8_t value);
-    virtual void writeHex16(std::string name, uint16_t value);
-    virtual void writeHex32(std::string name, uint32_t value);
-
-    virtual void writeFloat(std::string name, float value);
-    virtual void writeDouble(std::string name, double value);
-    virtual void writeString(std::string name, std::string value);
-
-    virtual void writeInt24Array(std::string name, std::vector<int32_t> values);
-    virtual void writeInt32Array(std::string name, std::vector<int32_t> values);
-    virtual void writeUInt24Array(std::string name, std::vector<uint32_t> values);
-    virtual void writeUInt32Array(std::string name, std::vector<uint32_t> values);
-    virtual void writeFloatArray(std::string name, std::vector<float> values);
-    virtual void writeDoubleArray(std::string name, std::vector<double> values);
+    virtual void writeInt8(std::string_view name, int8_t value);
+    virtual void writeInt16(std::string_view name, int16_t value);
+    virtual void writeInt24(std::string_view name, int32_t value);
+    virtual void writeInt32(std::string_view name, int32_t value);
+
+    virtual void writeUInt8(std::string_view name, uint8_t value);
+    virtual void writeUInt16(std::string_view name, uint16_t value);
+    virtual void writeUInt24(std::string_view name, uint32_t value);
+    virtual void writeUInt32(std::string_view name, uint32_t value);
+
+    virtual void writeHex8(std::string_view name, uint8_t value);
+    virtual void writeHex16(std::string_view name, uint16_t value);
+    virtual void writeHex32(std::string_view name, uint32_t value);
+
+    virtual void writeFloat(std::string_view name, float value);
+    virtual void writeDouble(std::string_view name, double value);
+    virtual void writeString(std::string_view name, std::string_view value);
+
+    virtual void writeInt24Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeInt32Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeUInt24Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeUInt32Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeFloatArray(std::string_view name, std::span<const float> values);
+    virtual void writeDoubleArray(std::string_view name, std::span<const double> values);
 
     // Structure Functions
     virtual void startFile(boost::json::object structure);
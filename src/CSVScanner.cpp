@@ -0,0 +1,232 @@
+#include "CSVScanner.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define BDC_CSV_SSE2
+    #if defined(__GNUC__) || defined(__clang__)
+        #define BDC_CSV_AVX2
+    #endif
+#endif
+
+constexpr std::size_t SCAN_WIDTH = 64;
+
+namespace
+{
+    struct Masks
+    {
+        uint64_t quotes;
+        uint64_t commas;
+        uint64_t lineBreaks;
+    };
+
+    using Classify = Masks (*)(const char* data);
+
+    [[maybe_unused]] Masks classifyScalar(const char* data)
+    {
+        Masks masks{};
+        for (std::size_t i = 0; i < SCAN_WIDTH; i++)
+        {
+            masks.quotes |= static_cast<uint64_t>(data[i] == '"') << i;
+            masks.commas |= static_cast<uint64_t>(data[i] == ',') << i;
+            masks.lineBreaks |= static_cast<uint64_t>(data[i] == '\n') << i;
+        }
+
+        return masks;
+    }
+
+#if defined(BDC_CSV_SSE2)
+    Masks classifySSE2(const char* data)
+    {
+        Masks masks{};
+        for (int i = 0; i < 4; i++)
+        {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+            auto shift = i * 16;
+
+            auto quotes     = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')));
+            auto commas     = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')));
+            auto lineBreaks = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+            masks.quotes |= static_cast<uint64_t>(static_cast<uint16_t>(quotes)) << shift;
+            masks.commas |= static_cast<uint64_t>(static_cast<uint16_t>(commas)) << shift;
+            masks.lineBreaks |= static_cast<uint64_t>(static_cast<uint16_t>(lineBreaks)) << shift;
+        }
+
+        return masks;
+    }
+#endif
+
+#if defined(BDC_CSV_AVX2)
+    __attribute__((target("avx2"))) Masks classifyAVX2(const char* data)
+    {
+        Masks masks{};
+        for (int i = 0; i < 2; i++)
+        {
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 32));
+            auto shift = i * 32;
+
+            auto quotes     = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"')));
+            auto commas     = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(',')));
+            auto lineBreaks = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+            masks.quotes |= static_cast<uint64_t>(static_cast<uint32_t>(quotes)) << shift;
+            masks.commas |= static_cast<uint64_t>(static_cast<uint32_t>(commas)) << shift;
+            masks.lineBreaks |= static_cast<uint64_t>(static_cast<uint32_t>(lineBreaks)) << shift;
+        }
+
+        return masks;
+    }
+#endif
+
+    Classify selectClassify()
+    {
+#if defined(BDC_CSV_AVX2)
+        if (__builtin_cpu_supports("avx2")) return classifyAVX2;
+#endif
+#if defined(BDC_CSV_SSE2)
+        return classifySSE2;
+#else
+        return classifyScalar;
+#endif
+    }
+
+    // every bit becomes the XOR of itself and all lower bits, setting the bits from an opening quote to its closing one
+    uint64_t prefixXor(uint64_t bits)
+    {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+} // namespace
+
+CSVScanner::CSVScanner(std::streambuf* buffer)
+    : buffer(buffer)
+    , block(CSV_BLOCK_SIZE + SCAN_WIDTH)
+{
+}
+
+void CSVScanner::fill()
+{
+    std::memmove(block.data(), block.data() + position, end - position);
+    end -= position;
+    scanned -= position;
+
+    separators.erase(separators.begin(), separators.begin() + nextSeparator);
+    for (auto& separator : separators)
+        separator -= static_cast<uint32_t>(position);
+    position      = 0;
+    nextSeparator = 0;
+
+    block.resize(end + CSV_BLOCK_SIZE + SCAN_WIDTH);
+    while (end < block.size() - SCAN_WIDTH)
+    {
+        auto count = buffer->sgetn(block.data() + end, static_cast<std::streamsize>(block.size() - SCAN_WIDTH - end));
+        if (count <= 0)
+        {
+            isEnd = true;
+            break;
+        }
+        end += count;
+    }
+    std::fill(block.begin() + end, block.end(), '\0');
+
+    scan();
+}
+
+void CSVScanner::scan()
+{
+    static const Classify classify = selectClassify();
+
+    // the last bytes of the file get scanned together with the padding, all others once a full chunk arrived
+    while (scanned + SCAN_WIDTH <= end || (isEnd && scanned < end))
+    {
+        auto masks  = classify(block.data() + scanned);
+        auto quoted = prefixXor(masks.quotes) ^ quoteCarry;
+        quoteCarry  = static_cast<uint64_t>(static_cast<int64_t>(quoted) >> 63);
+
+        for (auto bits = (masks.commas | masks.lineBreaks) & ~quoted; bits != 0; bits &= bits - 1)
+            separators.push_back(static_cast<uint32_t>(scanned + std::countr_zero(bits)));
+        scanned += SCAN_WIDTH;
+    }
+}
+
+void CSVScanner::setField(std::vector<std::string>& row, std::size_t index, std::size_t start, std::size_t stop)
+{
+    if (index == row.size()) row.emplace_back();
+    auto& field = row[index];
+
+    if (stop == start || block[start] != '"')
+    {
+        field.assign(block.data() + start, stop - start);
+        return;
+    }
+
+    // copies the runs between quotes, doubled quotes inside quotes become one
+    field.clear();
+    bool isQuoted = false;
+    for (auto it = start; it < stop;)
+    {
+        auto quote = static_cast<const char*>(std::memchr(block.data() + it, '"', stop - it));
+        auto next  = quote ? static_cast<std::size_t>(quote - block.data()) : stop;
+        field.append(block.data() + it, next - it);
+        if (!quote) break;
+
+        if (isQuoted && next + 1 < stop && block[next + 1] == '"')
+        {
+            field.push_back('"');
+            it = next + 2;
+        }
+        else
+        {
+            isQuoted = !isQuoted;
+            it       = next + 1;
+        }
+    }
+}
+
+bool CSVScanner::next(std::vector<std::string>& row)
+{
+    // a row that continues past the scanned text gets split again once the next block arrived
+    while (true)
+    {
+        auto fieldStart        = position;
+        std::size_t fieldCount = 0;
+
+        for (auto separator = nextSeparator; separator < separators.size(); separator++)
+        {
+            auto at = separators[separator];
+            if (block[at] == ',')
+            {
+                setField(row, fieldCount++, fieldStart, at);
+                fieldStart = at + 1;
+                continue;
+            }
+
+            setField(row, fieldCount++, fieldStart, at > fieldStart && block[at - 1] == '\r' ? at - 1 : at);
+            row.resize(fieldCount);
+            position      = at + 1;
+            nextSeparator = separator + 1;
+            return true;
+        }
+
+        if (isEnd)
+        {
+            // the last row doesn't need a line break
+            if (fieldStart >= end && fieldCount == 0) return false;
+
+            setField(row, fieldCount++, fieldStart, end > fieldStart && block[end - 1] == '\r' ? end - 1 : end);
+            row.resize(fieldCount);
+            position      = end;
+            nextSeparator = separators.size();
+            return true;
+        }
+
+        fill();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// bytes read from the file at once
+constexpr std::size_t CSV_BLOCK_SIZE = 1024 * 1024;
+
+/*
+ * Splits CSV text into rows and fields in two stages. The first one classifies 64 bytes at a time into bit masks of
+ * quotes, commas and line breaks, using AVX2 or SSE2 where available, removes the separators between quotes with a
+ * prefix XOR of the quote mask and records the positions of the remaining ones. The second one cuts the fields at
+ * those positions, only the bytes of quoted fields get looked at again to remove their quotes.
+ * Follows RFC 4180: fields may be quoted, quotes inside them are doubled and rows end with LF or CRLF.
+ */
+class CSVScanner
+{
+    std::streambuf* buffer;
+    std::vector<char> block;             // unconsumed text, followed by zeroed padding for the last 64 bytes
+    std::size_t end      = 0;            // of the text in the block
+    std::size_t scanned  = 0;            // of the text classified by the first stage
+    std::size_t position = 0;            // start of the next row
+    std::vector<uint32_t> separators{};  // unquoted commas and line breaks, in the order of the text
+    std::size_t nextSeparator = 0;       // first one of the next row
+    uint64_t quoteCarry       = 0;       // all ones when the scanned text ends inside quotes
+    bool isEnd                = false;
+
+    // moves the unconsumed text to the start of the block and appends the next block of the file
+    void fill();
+    void scan();
+    void setField(std::vector<std::string>& row, std::size_t index, std::size_t start, std::size_t stop);
+
+public:
+    CSVScanner(std::streambuf* buffer);
+
+    // reuses the strings of the previous row, false when there are no rows left
+    bool next(std::vector<std::string>& row);
+};
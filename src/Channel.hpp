@@ -1,13 +1,20 @@
 #pragma once
 
+#include "Structure.hpp"
+
 #include <boost/json.hpp>
 
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Reader
 {
 public:
+    virtual ~Reader() = default;
+
     // Read Functions
     virtual int8_t readInt8()   = 0;
     virtual int16_t readInt16() = 0;
@@ -26,46 +33,55 @@ public:
     virtual float readFloat()   = 0;
     virtual double readDouble() = 0;
 
-    virtual std::string readString() = 0;
+    // read into caller owned buffers, so their capacity can be reused
+    virtual void readString(std::pmr::string& value) = 0;
 
-    virtual std::vector<int32_t> readInt24Array()   = 0;
-    virtual std::vector<int32_t> readInt32Array()   = 0;
-    virtual std::vector<uint32_t> readUInt24Array() = 0;
-    virtual std::vector<uint32_t> readUInt32Array() = 0;
-    virtual std::vector<float> readFloatArray()     = 0;
-    virtual std::vector<double> readDoubleArray()   = 0;
+    virtual void readInt24Array(std::pmr::vector<int32_t>& values)   = 0;
+    virtual void readInt32Array(std::pmr::vector<int32_t>& values)   = 0;
+    virtual void readUInt24Array(std::pmr::vector<uint32_t>& values) = 0;
+    virtual void readUInt32Array(std::pmr::vector<uint32_t>& values) = 0;
+    virtual void readFloatArray(std::pmr::vector<float>& values)     = 0;
+    virtual void readDoubleArray(std::pmr::vector<double>& values)   = 0;
 
     virtual bool hasNext() = 0;
+
+    // Random Access Functions
+    virtual std::size_t getFieldSize(FieldType type) = 0; // 0 for variable-length fields
+    virtual void skip(FieldType type)                = 0;
+    virtual std::size_t getPosition()                = 0;
+    virtual void setPosition(std::size_t position)   = 0;
 };
 
 class Writer
 {
 public:
+    virtual ~Writer() = default;
+
     // Write Functions
-    virtual void writeInt8(std::string name, int8_t value)   = 0;
-    virtual void writeInt16(std::string name, int16_t value) = 0;
-    virtual void writeInt24(std::string name, int32_t value) = 0;
-    virtual void writeInt32(std::string name, int32_t value) = 0;
-
-    virtual void writeUInt8(std::string name, uint8_t value)   = 0;
-    virtual void writeUInt16(std::string name, uint16_t value) = 0;
-    virtual void writeUInt24(std::string name, uint32_t value) = 0;
-    virtual void writeUInt32(std::string name, uint32_t value) = 0;
-
-    virtual void writeHex8(std::string name, uint8_t value)   = 0;
-    virtual void writeHex16(std::string name, uint16_t value) = 0;
-    virtual void writeHex32(std::string name, uint32_t value) = 0;
-
-    virtual void writeFloat(std::string name, float value)        = 0;
-    virtual void writeDouble(std::string name, double value)      = 0;
-    virtual void writeString(std::string name, std::string value) = 0;
-
-    virtual void writeInt24Array(std::string name, std::vector<int32_t> values)   = 0;
-    virtual void writeInt32Array(std::string name, std::vector<int32_t> values)   = 0;
-    virtual void writeUInt24Array(std::string name, std::vector<uint32_t> values) = 0;
-    virtual void writeUInt32Array(std::string name, std::vector<uint32_t> values) = 0;
-    virtual void writeFloatArray(std::string name, std::vector<float> values)     = 0;
-    virtual void writeDoubleArray(std::string name, std::vector<double> values)   = 0;
+    virtual void writeInt8(std::string_view name, int8_t value)   = 0;
+    virtual void writeInt16(std::string_view name, int16_t value) = 0;
+    virtual void writeInt24(std::string_view name, int32_t value) = 0;
+    virtual void writeInt32(std::string_view name, int32_t value) = 0;
+
+    virtual void writeUInt8(std::string_view name, uint8_t value)   = 0;
+    virtual void writeUInt16(std::string_view name, uint16_t value) = 0;
+    virtual void writeUInt24(std::string_view name, uint32_t value) = 0;
+    virtual void writeUInt32(std::string_view name, uint32_t value) = 0;
+
+    virtual void writeHex8(std::string_view name, uint8_t value)   = 0;
+    virtual void writeHex16(std::string_view name, uint16_t value) = 0;
+    virtual void writeHex32(std::string_view name, uint32_t value) = 0;
+
+    virtual void writeFloat(std::string_view name, float value)             = 0;
+    virtual void writeDouble(std::string_view name, double value)           = 0;
+    virtual void writeString(std::string_view name, std::string_view value) = 0;
+
+    virtual void writeInt24Array(std::string_view name, std::span<const int32_t> values)   = 0;
+    virtual void writeInt32Array(std::string_view name, std::span<const int32_t> values)   = 0;
+    virtual void writeUInt24Array(std::string_view name, std::span<const uint32_t> values) = 0;
+    virtual void writeUInt32Array(std::string_view name, std::span<const uint32_t> values) = 0;
+    virtual void writeFloatArray(std::string_view name, std::span<const float> values)     = 0;
+    virtual void writeDoubleArray(std::string_view name, std::span<const double> values)   = 0;
 
     // Structure Functions
     virtual void startFile(boost::json::object structure) = 0;
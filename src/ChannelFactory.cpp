@@ -0,0 +1,61 @@
+#include "ChannelFactory.hpp"
+
+#include "CSVChannel.hpp"
+#include "Trace.hpp"
+
+#ifdef BDC_SQLITE
+    #include "SQLiteChannel.hpp"
+#endif
+
+#include <boost/algorithm/string.hpp>
+
+std::unique_ptr<Reader> readerFactory(boost::json::object config, const Structure& structure)
+{
+    std::string format(config["format"].as_string());
+    boost::algorithm::to_lower(format);
+
+    TraceSpan span("create reader", format);
+    if (auto binaryFormat = getChannelBinaryFormat(config)) return makeBinaryReader(*binaryFormat, config);
+    if (format.compare("csv") == 0) return std::make_unique<CSVReader>(config);
+    if (format.compare("sqlite") == 0)
+    {
+#ifdef BDC_SQLITE
+        return std::make_unique<SQLiteReader>(config, structure);
+#else
+        throw std::runtime_error("SQLite databases require a build with SQLite.");
+#endif
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<Writer> writerFactory(boost::json::object config)
+{
+    std::string format(config["format"].as_string());
+    boost::algorithm::to_lower(format);
+
+    TraceSpan span("create writer", format);
+    if (auto binaryFormat = getChannelBinaryFormat(config)) return makeBinaryWriter(*binaryFormat, config);
+    if (format.compare("csv") == 0) return std::make_unique<CSVWriter>(config);
+    if (format.compare("sqlite") == 0)
+    {
+#ifdef BDC_SQLITE
+        return std::make_unique<SQLiteWriter>(config);
+#else
+        throw std::runtime_error("SQLite databases require a build with SQLite.");
+#endif
+    }
+
+    return nullptr;
+}
+
+std::optional<BinaryFormat> getChannelBinaryFormat(boost::json::object config)
+{
+    std::string format(config["format"].as_string());
+    boost::algorithm::to_lower(format);
+
+    if (format.compare("binary") == 0) return getBinaryFormat(config, PLAIN_BINARY_FORMAT);
+    if (format.compare("survivebinary") == 0) return getBinaryFormat(config, SURVIVE_BINARY_FORMAT);
+
+    return std::nullopt;
+}
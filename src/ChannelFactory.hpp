@@ -0,0 +1,14 @@
+#pragma once
+
+#include "BinaryChannel.hpp"
+#include "Channel.hpp"
+
+#include <memory>
+#include <optional>
+
+// the structure names the fields for formats that look them up by name
+std::unique_ptr<Reader> readerFactory(boost::json::object config, const Structure& structure);
+std::unique_ptr<Writer> writerFactory(boost::json::object config);
+
+// the encodings of a "binary" or "surviveBinary" channel, nothing for other formats
+std::optional<BinaryFormat> getChannelBinaryFormat(boost::json::object config);
@@ -0,0 +1,143 @@
+#include "Codegen.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    struct RecordMember
+    {
+        std::string name;
+        std::string type;
+        std::size_t size;
+        std::size_t offset;
+        std::size_t encodedSize;
+        std::size_t encodedOffset;
+        std::string encoding;
+        bool isStringIndex = false;
+    };
+
+    bool isIdentifier(const std::string& name)
+    {
+        auto isWordChar = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+        return !name.empty() && !std::isdigit(static_cast<unsigned char>(name[0])) &&
+               std::all_of(name.begin(), name.end(), isWordChar);
+    }
+
+    // C++ type, size and encoding of a field
+    RecordMember getMember(const Field& field, const BinaryFormat& format)
+    {
+        auto int24 = format.int24Encoding == Int24Encoding::SIGN_MAGNITUDE ? "INT24_SIGN_MAGNITUDE" : "INT24";
+        auto real  = format.floatEncoding == FloatEncoding::DECIMAL24 ? "DECIMAL24" : "VALUE";
+
+        RecordMember member;
+        switch (field.type)
+        {
+            case FieldType::INT8: member = { field.name, "int8_t", 1, 0, 0, 0, "VALUE" }; break;
+            case FieldType::INT16: member = { field.name, "int16_t", 2, 0, 0, 0, "VALUE" }; break;
+            case FieldType::INT24: member = { field.name, "int32_t", 4, 0, 0, 0, int24 }; break;
+            case FieldType::INT32: member = { field.name, "int32_t", 4, 0, 0, 0, "VALUE" }; break;
+            case FieldType::UINT8:
+            case FieldType::HEX8: member = { field.name, "uint8_t", 1, 0, 0, 0, "VALUE" }; break;
+            case FieldType::UINT16:
+            case FieldType::HEX16: member = { field.name, "uint16_t", 2, 0, 0, 0, "VALUE" }; break;
+            case FieldType::UINT24: member = { field.name, "uint32_t", 4, 0, 0, 0, "UINT24" }; break;
+            case FieldType::UINT32:
+            case FieldType::HEX32: member = { field.name, "uint32_t", 4, 0, 0, 0, "VALUE" }; break;
+            case FieldType::FLOAT: member = { field.name, "float", 4, 0, 0, 0, real }; break;
+            case FieldType::DOUBLE: member = { field.name, "double", 8, 0, 0, 0, real }; break;
+            case FieldType::STRING:
+                if (format.stringEncoding == StringEncoding::TABLE)
+                {
+                    member = { field.name, "uint16_t", 2, 0, 0, 0, "VALUE", true };
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                throw std::runtime_error("Only structures of fixed size entries can be generated, " + field.name +
+                                         " has a variable size.");
+        }
+
+        member.encodedSize = getEncodedSize(format, field.type);
+        return member;
+    }
+} // namespace
+
+std::string generateRecordHeader(const std::string& name,
+                                 const Structure& structure,
+                                 const BinaryFormat& format,
+                                 const std::string& source)
+{
+    if (!isIdentifier(name)) throw std::runtime_error("Not a valid type name: " + name);
+
+    std::vector<RecordMember> members;
+    std::size_t size        = 0;
+    std::size_t encodedSize = 0;
+    for (auto& field : structure.getFields())
+    {
+        if (!isIdentifier(field.name)) throw std::runtime_error("Not a valid member name: " + field.name);
+
+        auto member          = getMember(field, format);
+        member.offset        = size;
+        member.encodedOffset = encodedSize;
+        size += member.size;
+        encodedSize += member.encodedSize;
+        members.push_back(member);
+    }
+
+    // stored exactly like the packed struct, apart from the byte order
+    bool isValueLayout = size == encodedSize && std::all_of(members.begin(),
+                                                            members.end(),
+                                                            [](auto& member) { return member.encoding == "VALUE"; });
+    std::string order  = format.byteOrder == ByteOrder::BIG ? "ByteOrder::BIG" : "ByteOrder::LITTLE";
+
+    std::ostringstream out;
+    out << "// Generated by bdc-codegen from " << source << ", changes get overwritten.\n";
+    out << "#pragma once\n\n";
+    out << "#include \"RecordCodec.hpp\"\n\n";
+    out << "#include <cstddef>\n#include <cstdint>\n#include <span>\n\n";
+
+    out << "#pragma pack(push, 1)\n";
+    out << "struct " << name << "\n{\n";
+    for (auto& member : members)
+    {
+        out << "    " << member.type << " " << member.name << ";";
+        if (member.isStringIndex) out << " // index into the string table";
+        out << "\n";
+    }
+
+    out << "\n";
+    out << "    static constexpr std::size_t ENCODED_SIZE = " << encodedSize << ";\n";
+    out << "    static constexpr ByteOrder ENCODED_BYTE_ORDER = " << order << ";\n";
+    out << "    static constexpr bool IS_NATIVE = "
+        << (isValueLayout ? "ENCODED_BYTE_ORDER == NATIVE_BYTE_ORDER" : "false") << ";\n";
+    out << "    static constexpr RecordField FIELDS[] = {\n";
+    for (auto& member : members)
+        out << "        { \"" << member.name << "\", " << member.offset << ", " << member.encodedOffset << ", "
+            << member.encodedSize << ", RecordEncoding::" << member.encoding << ", " << order << " },\n";
+    out << "    };\n\n";
+
+    out << "    static " << name << " decode(std::span<const char, ENCODED_SIZE> bytes)\n    {\n";
+    out << "        " << name << " record;\n";
+    for (auto& member : members)
+        out << "        record." << member.name << " = loadField<" << order << ", RecordEncoding::" << member.encoding
+            << ", " << member.type << ">(bytes.data() + " << member.encodedOffset << ");\n";
+    out << "        return record;\n    }\n\n";
+
+    out << "    void encode(std::span<char, ENCODED_SIZE> bytes) const\n    {\n";
+    for (auto& member : members)
+        out << "        storeField<" << order << ", RecordEncoding::" << member.encoding << ">(" << member.name
+            << ", bytes.data() + " << member.encodedOffset << ");\n";
+    out << "    }\n";
+    out << "};\n";
+    out << "#pragma pack(pop)\n\n";
+
+    out << "static_assert(sizeof(" << name << ") == " << size << ");\n";
+    for (auto& member : members)
+        out << "static_assert(offsetof(" << name << ", " << member.name << ") == " << member.offset << ");\n";
+
+    return out.str();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BinaryChannel.hpp"
+#include "Structure.hpp"
+
+#include <string>
+
+/*
+ * Generates a header with a packed record type for the entries of a structure stored in the given format. Every field
+ * becomes a member of its natural C++ type, 24 bit integers and floats become 32 bit ones and table strings their
+ * 16 bit index. The layout is checked by static_asserts, every field is described by the FIELDS metadata and
+ * decode/encode convert single records with all encodings resolved at compile time. RecordCodec.hpp decodes and
+ * encodes whole files of them. Only structures of fixed size entries are supported.
+ */
+std::string generateRecordHeader(const std::string& name,
+                                 const Structure& structure,
+                                 const BinaryFormat& format,
+                                 const std::string& source);
@@ -0,0 +1,254 @@
+#include "CompressedStream.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+
+constexpr std::size_t COMPRESSION_BLOCK_SIZE  = 256 * 1024;
+constexpr std::size_t COMPRESSION_QUEUE_DEPTH = 4;
+
+Compression getCompression(const boost::json::object& config, const std::string& path)
+{
+    if (auto value = config.if_contains("compression"); value && value->is_string())
+    {
+        std::string compression(value->as_string());
+        boost::algorithm::to_lower(compression);
+
+        if (compression == "gzip" || compression == "gz") return Compression::GZIP;
+        if (compression == "zstd" || compression == "zst") return Compression::ZSTD;
+        if (compression == "none") return Compression::NONE;
+
+        throw std::runtime_error("Unknown compression: " + compression);
+    }
+
+    if (boost::algorithm::iends_with(path, ".gz")) return Compression::GZIP;
+    if (boost::algorithm::iends_with(path, ".zst")) return Compression::ZSTD;
+
+    return Compression::NONE;
+}
+
+/* Block Queue */
+BlockQueue::BlockQueue(std::size_t capacity)
+    : capacity(capacity)
+{
+}
+
+bool BlockQueue::push(std::vector<char> block)
+{
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&] { return isClosed || blocks.size() < capacity; });
+    if (isClosed) return false;
+
+    blocks.push_back(std::move(block));
+    changed.notify_all();
+    return true;
+}
+
+bool BlockQueue::pop(std::vector<char>& block)
+{
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&] { return isClosed || !blocks.empty(); });
+    if (blocks.empty()) return false;
+
+    block = std::move(blocks.front());
+    blocks.pop_front();
+    changed.notify_all();
+    return true;
+}
+
+void BlockQueue::close()
+{
+    std::lock_guard lock(mutex);
+    isClosed = true;
+    changed.notify_all();
+}
+
+/* Decompressing Buffer */
+DecompressingBuffer::DecompressingBuffer(std::unique_ptr<std::streambuf> fileBuffer, Compression compression)
+    : fileBuffer(std::move(fileBuffer))
+    , queue(COMPRESSION_QUEUE_DEPTH)
+{
+    if (compression == Compression::GZIP) filter.push(boost::iostreams::gzip_decompressor());
+    if (compression == Compression::ZSTD) filter.push(boost::iostreams::zstd_decompressor());
+    filter.push(*this->fileBuffer);
+
+    setg(nullptr, nullptr, nullptr);
+    worker = std::thread(&DecompressingBuffer::decompress, this);
+}
+
+DecompressingBuffer::~DecompressingBuffer()
+{
+    queue.close();
+    worker.join();
+}
+
+void DecompressingBuffer::decompress()
+{
+    try
+    {
+        while (true)
+        {
+            std::vector<char> block(COMPRESSION_BLOCK_SIZE);
+            auto count = filter.sgetn(block.data(), block.size());
+            block.resize(std::max<std::streamsize>(count, 0));
+
+            bool isEnd = block.empty();
+            if (!queue.push(std::move(block)) || isEnd) return;
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        queue.push({});
+    }
+}
+
+DecompressingBuffer::int_type DecompressingBuffer::underflow()
+{
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    position += current.size();
+    current.clear();
+    queue.pop(current);
+
+    // an empty block marks the end of the data
+    setg(current.data(), current.data(), current.data() + current.size());
+    if (current.empty())
+    {
+        if (error) std::rethrow_exception(error);
+        return traits_type::eof();
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+DecompressingBuffer::pos_type
+DecompressingBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::end) return pos_type(off_type(-1));
+    if (dir == std::ios::cur) offset += position + (gptr() - eback());
+
+    return seekpos(pos_type(offset), which);
+}
+
+DecompressingBuffer::pos_type DecompressingBuffer::seekpos(pos_type target, std::ios::openmode which)
+{
+    if (!(which & std::ios::in)) return pos_type(off_type(-1));
+
+    auto current = static_cast<uint64_t>(off_type(target));
+    if (current < position + (gptr() - eback())) return pos_type(off_type(-1));
+
+    // forward seeks simply decompress and discard the data in between
+    while (current >= position + (egptr() - eback()))
+    {
+        setg(eback(), egptr(), egptr());
+        if (traits_type::eq_int_type(underflow(), traits_type::eof())) return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + (current - position), egptr());
+    return target;
+}
+
+/* Compressing Buffer */
+CompressingBuffer::CompressingBuffer(std::unique_ptr<std::streambuf> fileBuffer, Compression compression)
+    : fileBuffer(std::move(fileBuffer))
+    , queue(COMPRESSION_QUEUE_DEPTH)
+    , current(COMPRESSION_BLOCK_SIZE)
+{
+    if (compression == Compression::GZIP) filter.push(boost::iostreams::gzip_compressor());
+    if (compression == Compression::ZSTD) filter.push(boost::iostreams::zstd_compressor());
+    filter.push(*this->fileBuffer);
+
+    setp(current.data(), current.data() + current.size());
+    worker = std::thread(&CompressingBuffer::compress, this);
+}
+
+CompressingBuffer::~CompressingBuffer() { finish(); }
+
+bool CompressingBuffer::finish()
+{
+    if (!worker.joinable()) return !hasError;
+
+    if (!submitCurrent()) hasError = true;
+    queue.close();
+    worker.join();
+
+    // flushes the remaining compressed data and writes the trailer
+    try
+    {
+        filter.reset();
+    }
+    catch (...)
+    {
+        hasError = true;
+    }
+
+    if (!finishOutputBuffer(*fileBuffer)) hasError = true;
+    return !hasError;
+}
+
+void CompressingBuffer::compress()
+{
+    try
+    {
+        std::vector<char> block;
+        while (queue.pop(block))
+            filter.sputn(block.data(), block.size());
+    }
+    catch (...)
+    {
+        hasError = true;
+        queue.close();
+    }
+}
+
+bool CompressingBuffer::submitCurrent()
+{
+    auto count = pptr() - pbase();
+    if (count == 0) return !hasError;
+
+    current.resize(count);
+    position += count;
+    bool isQueued = queue.push(std::move(current));
+
+    current = std::vector<char>(COMPRESSION_BLOCK_SIZE);
+    setp(current.data(), current.data() + current.size());
+    return isQueued && !hasError;
+}
+
+CompressingBuffer::int_type CompressingBuffer::overflow(int_type ch)
+{
+    if (!submitCurrent()) return traits_type::eof();
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+// doesn't wait for the compression to finish, there is nothing a caller could do with a partial frame anyway
+int CompressingBuffer::sync() { return submitCurrent() ? 0 : -1; }
+
+CompressingBuffer::pos_type
+CompressingBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::end) return pos_type(off_type(-1));
+    if (dir == std::ios::cur) offset += position + (pptr() - pbase());
+
+    return seekpos(pos_type(offset), which);
+}
+
+CompressingBuffer::pos_type CompressingBuffer::seekpos(pos_type target, std::ios::openmode which)
+{
+    if (!(which & std::ios::out)) return pos_type(off_type(-1));
+
+    auto current = static_cast<uint64_t>(off_type(target));
+    auto written = position + (pptr() - pbase());
+    if (current < written) return pos_type(off_type(-1));
+
+    // forward seeks fill the gap with zeroes, like seeking past the end of a regular file would
+    for (; written < current; written++)
+        if (traits_type::eq_int_type(sputc(0), traits_type::eof())) return pos_type(off_type(-1));
+
+    return target;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "OutputBuffer.hpp"
+
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/json.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Compression
+{
+    NONE,
+    GZIP,
+    ZSTD,
+};
+
+/*
+ * Uses the "compression" key of the channel config ("none", "gzip" or "zstd") when present,
+ * the file extension (.gz or .zst) otherwise.
+ */
+Compression getCompression(const boost::json::object& config, const std::string& path);
+
+class BlockQueue
+{
+    std::deque<std::vector<char>> blocks;
+    std::size_t capacity;
+    bool isClosed = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+public:
+    BlockQueue(std::size_t capacity);
+
+    bool push(std::vector<char> block);
+    bool pop(std::vector<char>& block);
+    void close();
+};
+
+/*
+ * Decompresses on a background thread into a bounded queue of blocks. Only supports forward seeking.
+ */
+class DecompressingBuffer : public std::streambuf
+{
+    std::unique_ptr<std::streambuf> fileBuffer;
+    boost::iostreams::filtering_streambuf<boost::iostreams::input> filter;
+    BlockQueue queue;
+    std::thread worker;
+    std::vector<char> current;
+    uint64_t position = 0; // uncompressed offset of the current block
+    std::exception_ptr error;
+
+    void decompress();
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    DecompressingBuffer(std::unique_ptr<std::streambuf> fileBuffer, Compression compression);
+    ~DecompressingBuffer();
+};
+
+/*
+ * Hands full blocks to a background thread that compresses them into the file. Only supports forward seeking.
+ */
+class CompressingBuffer : public std::streambuf, public OutputBuffer
+{
+    std::unique_ptr<std::streambuf> fileBuffer;
+    boost::iostreams::filtering_streambuf<boost::iostreams::output> filter;
+    BlockQueue queue;
+    std::thread worker;
+    std::vector<char> current;
+    uint64_t position = 0; // uncompressed offset of the current block
+    std::atomic<bool> hasError = false;
+
+    void compress();
+    bool submitCurrent();
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    CompressingBuffer(std::unique_ptr<std::streambuf> fileBuffer, Compression compression);
+    ~CompressingBuffer();
+
+    // waits for the compression and writes the trailer
+    bool finish() override;
+};
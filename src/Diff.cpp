@@ -0,0 +1,350 @@
+#include "Diff.hpp"
+
+#include "CSVChannel.hpp"
+#include "Hash.hpp"
+#include "KeyIndex.hpp"
+#include "ReadWriter.hpp"
+#include "Trace.hpp"
+
+#include <boost/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+namespace
+{
+    using Delta = std::variant<std::monostate, int64_t, double>;
+
+    // string keys are ordered by their hash first, like in a KeyIndex, but always matched by their value
+    struct EntryKey
+    {
+        uint64_t key;
+        std::string_view string;
+        std::size_t entry;
+
+        auto operator<=>(const EntryKey& other) const = default;
+    };
+
+    template<typename T> bool isSameValue(const T& a, const T& b)
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+            return std::memcmp(&a, &b, sizeof(T)) == 0;
+        else
+            return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size_bytes()) == 0);
+    }
+
+    template<> bool isSameValue(const std::string_view& a, const std::string_view& b) { return a == b; }
+
+    // the same keys as stored in a KeyIndex
+    uint64_t getKey(const Column& column, std::size_t row)
+    {
+        auto key = [&](auto& values) -> uint64_t
+        {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+                return static_cast<uint64_t>(static_cast<int64_t>(values[row]));
+            else if constexpr (std::is_integral_v<T>)
+                return values[row];
+            else if constexpr (std::is_same_v<T, std::string_view>)
+                return fnv1a(values[row].data(), values[row].size());
+            else
+                return 0; // rejected by checkKeyField
+        };
+        return std::visit(key, column);
+    }
+
+    std::vector<EntryKey> getKeys(const Table& table, std::size_t keyField)
+    {
+        auto& column = table.getColumn(keyField);
+        auto strings = std::get_if<std::vector<std::string_view>>(&column);
+
+        std::vector<EntryKey> keys(table.getRowCount());
+        for (std::size_t row = 0; row < keys.size(); row++)
+            keys[row] = { getKey(column, row), strings ? (*strings)[row] : std::string_view(), row };
+
+        // entries sharing a key stay in file order
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    std::vector<std::size_t>
+    getChangedFields(const Table& oldTable, const Table& newTable, std::size_t oldEntry, std::size_t newEntry)
+    {
+        std::vector<std::size_t> fields;
+        for (std::size_t field = 0; field < oldTable.getLayout().getFields().size(); field++)
+        {
+            auto compare = [&](auto& oldValues)
+            {
+                auto& newValues = std::get<std::decay_t<decltype(oldValues)>>(newTable.getColumn(field));
+                return isSameValue(oldValues[oldEntry], newValues[newEntry]);
+            };
+            if (!std::visit(compare, oldTable.getColumn(field))) fields.push_back(field);
+        }
+
+        return fields;
+    }
+
+    // a value as it would be written to a CSV file
+    std::string formatValue(const Table& table, std::size_t field, std::size_t row)
+    {
+        auto& info = table.getLayout().getFields()[field];
+
+        std::ostringstream stream;
+        CSVWriter writer(stream);
+        getReadWriter(info.type).write(info.name, table.getColumn(field), row, writer);
+        return std::move(stream).str();
+    }
+
+    bool isHex(FieldType type)
+    {
+        return type == FieldType::HEX8 || type == FieldType::HEX16 || type == FieldType::HEX32;
+    }
+
+    boost::json::value toJson(const Table& table, std::size_t field, std::size_t row)
+    {
+        // hex values keep their digits, quoted like in CSV files
+        if (isHex(table.getLayout().getFields()[field].type))
+        {
+            auto text = formatValue(table, field, row);
+            return boost::json::string(text.substr(1, text.size() - 2));
+        }
+
+        auto convert = [](auto value) -> boost::json::value
+        {
+            if constexpr (std::is_floating_point_v<decltype(value)>)
+                return static_cast<double>(value);
+            else if constexpr (std::is_signed_v<decltype(value)>)
+                return static_cast<int64_t>(value);
+            else
+                return static_cast<uint64_t>(value);
+        };
+        auto visit = [&](auto& values) -> boost::json::value
+        {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            if constexpr (std::is_arithmetic_v<T>)
+                return convert(values[row]);
+            else if constexpr (std::is_same_v<T, std::string_view>)
+                return boost::json::string(values[row]);
+            else
+            {
+                boost::json::array array;
+                for (auto value : values[row])
+                    array.push_back(convert(value));
+                return array;
+            }
+        };
+        return std::visit(visit, table.getColumn(field));
+    }
+
+    // new minus old for numbers, nothing for hex fields, strings and arrays
+    Delta getDelta(const Table& oldTable,
+                   const Table& newTable,
+                   std::size_t field,
+                   std::size_t oldEntry,
+                   std::size_t newEntry)
+    {
+        if (isHex(oldTable.getLayout().getFields()[field].type)) return {};
+
+        auto delta = [&](auto& oldValues) -> Delta
+        {
+            using T         = typename std::decay_t<decltype(oldValues)>::value_type;
+            auto& newValues = std::get<std::decay_t<decltype(oldValues)>>(newTable.getColumn(field));
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<int64_t>(newValues[newEntry]) - static_cast<int64_t>(oldValues[oldEntry]);
+            else if constexpr (std::is_floating_point_v<T>)
+                return static_cast<double>(newValues[newEntry]) - static_cast<double>(oldValues[oldEntry]);
+            else
+                return {};
+        };
+        return std::visit(delta, oldTable.getColumn(field));
+    }
+} // namespace
+
+TableDiff
+diffTables(const Table& oldTable, const Table& newTable, std::optional<std::size_t> keyField, std::size_t threadCount)
+{
+    if (keyField) checkKeyField(oldTable.getLayout().getFields().at(*keyField));
+
+    TraceSpan span("match entries");
+    TableDiff diff;
+    std::vector<std::pair<std::size_t, std::size_t>> matched; // old and new entry
+    if (!keyField)
+    {
+        auto common = std::min(oldTable.getRowCount(), newTable.getRowCount());
+        for (std::size_t entry = 0; entry < common; entry++)
+            matched.emplace_back(entry, entry);
+        for (auto entry = common; entry < oldTable.getRowCount(); entry++)
+            diff.removed.push_back(entry);
+        for (auto entry = common; entry < newTable.getRowCount(); entry++)
+            diff.added.push_back(entry);
+    }
+    else
+    {
+        // both key lists are sorted, so they can be merged like two sorted files
+        auto oldKeys  = getKeys(oldTable, *keyField);
+        auto newKeys  = getKeys(newTable, *keyField);
+        auto keyOrder = [](const EntryKey& a, const EntryKey& b)
+        {
+            return std::tie(a.key, a.string) <=> std::tie(b.key, b.string);
+        };
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < oldKeys.size() && j < newKeys.size())
+        {
+            auto order = keyOrder(oldKeys[i], newKeys[j]);
+            if (order < 0)
+                diff.removed.push_back(oldKeys[i++].entry);
+            else if (order > 0)
+                diff.added.push_back(newKeys[j++].entry);
+            else
+                matched.emplace_back(oldKeys[i++].entry, newKeys[j++].entry);
+        }
+        for (; i < oldKeys.size(); i++)
+            diff.removed.push_back(oldKeys[i].entry);
+        for (; j < newKeys.size(); j++)
+            diff.added.push_back(newKeys[j].entry);
+    }
+
+    // every matched entry gets compared field by field, blocks of them on multiple threads
+    std::vector<std::vector<std::size_t>> changedFields(matched.size());
+    {
+        TraceSpan compareSpan("compare entries");
+        auto blockCount = (matched.size() + DIFF_BLOCK_SIZE - 1) / DIFF_BLOCK_SIZE;
+
+        std::atomic<std::size_t> nextBlock = 0;
+        auto worker = [&]()
+        {
+            for (std::size_t block; (block = nextBlock++) < blockCount;)
+            {
+                TraceSpan blockSpan("compare block", std::to_string(block * DIFF_BLOCK_SIZE));
+
+                auto last = std::min(matched.size(), (block + 1) * DIFF_BLOCK_SIZE);
+                for (auto i = block * DIFF_BLOCK_SIZE; i < last; i++)
+                    changedFields[i] = getChangedFields(oldTable, newTable, matched[i].first, matched[i].second);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < std::min(threadCount, blockCount); i++)
+            threads.emplace_back(worker);
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    for (std::size_t i = 0; i < matched.size(); i++)
+        if (!changedFields[i].empty())
+            diff.changed.push_back({ matched[i].first, matched[i].second, std::move(changedFields[i]) });
+
+    std::sort(diff.removed.begin(), diff.removed.end());
+    std::sort(diff.added.begin(), diff.added.end());
+    std::sort(diff.changed.begin(), diff.changed.end(), [](auto& a, auto& b) { return a.newEntry < b.newEntry; });
+    return diff;
+}
+
+void writeDiffCSV(std::ostream& stream,
+                  const Table& oldTable,
+                  const Table& newTable,
+                  const TableDiff& diff,
+                  std::optional<std::size_t> keyField)
+{
+    auto& fields = oldTable.getLayout().getFields();
+
+    stream << "change,oldEntry,newEntry,";
+    if (keyField) stream << fields[*keyField].name << ',';
+    stream << "field,old,new,delta\n";
+
+    auto writeEntry = [&](const char* change, const Table& table, std::size_t entry, bool isOld)
+    {
+        stream << change << ',';
+        if (isOld) stream << entry;
+        stream << ',';
+        if (!isOld) stream << entry;
+        stream << ',';
+        if (keyField) stream << formatValue(table, *keyField, entry) << ',';
+        stream << ",,,\n";
+    };
+
+    for (auto entry : diff.removed)
+        writeEntry("removed", oldTable, entry, true);
+    for (auto entry : diff.added)
+        writeEntry("added", newTable, entry, false);
+
+    for (auto& changed : diff.changed)
+    {
+        for (auto field : changed.fields)
+        {
+            stream << "changed," << changed.oldEntry << ',' << changed.newEntry << ',';
+            if (keyField) stream << formatValue(newTable, *keyField, changed.newEntry) << ',';
+            stream << fields[field].name << ',' << formatValue(oldTable, field, changed.oldEntry) << ','
+                   << formatValue(newTable, field, changed.newEntry) << ',';
+
+            auto delta = getDelta(oldTable, newTable, field, changed.oldEntry, changed.newEntry);
+            if (auto value = std::get_if<int64_t>(&delta)) stream << *value;
+            if (auto value = std::get_if<double>(&delta)) stream << *value;
+            stream << '\n';
+        }
+    }
+}
+
+void writeDiffJson(std::ostream& stream,
+                   const Table& oldTable,
+                   const Table& newTable,
+                   const TableDiff& diff,
+                   std::optional<std::size_t> keyField)
+{
+    auto& fields = oldTable.getLayout().getFields();
+
+    auto makeEntry = [&](const Table& table, std::size_t entry)
+    {
+        boost::json::object object;
+        object["entry"] = entry;
+        if (keyField) object["key"] = toJson(table, *keyField, entry);
+        return object;
+    };
+
+    boost::json::array removed;
+    for (auto entry : diff.removed)
+        removed.push_back(makeEntry(oldTable, entry));
+
+    boost::json::array added;
+    for (auto entry : diff.added)
+        added.push_back(makeEntry(newTable, entry));
+
+    boost::json::array changed;
+    for (auto& entry : diff.changed)
+    {
+        boost::json::object values;
+        for (auto field : entry.fields)
+        {
+            boost::json::object value;
+            value["old"] = toJson(oldTable, field, entry.oldEntry);
+            value["new"] = toJson(newTable, field, entry.newEntry);
+
+            auto delta = getDelta(oldTable, newTable, field, entry.oldEntry, entry.newEntry);
+            if (auto number = std::get_if<int64_t>(&delta)) value["delta"] = *number;
+            if (auto number = std::get_if<double>(&delta)) value["delta"] = *number;
+            values[fields[field].name] = std::move(value);
+        }
+
+        boost::json::object object;
+        object["oldEntry"] = entry.oldEntry;
+        object["newEntry"] = entry.newEntry;
+        if (keyField) object["key"] = toJson(newTable, *keyField, entry.newEntry);
+        object["fields"] = std::move(values);
+        changed.push_back(std::move(object));
+    }
+
+    boost::json::object report;
+    report["removed"] = std::move(removed);
+    report["added"]   = std::move(added);
+    report["changed"] = std::move(changed);
+    stream << report << '\n';
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Table.hpp"
+
+#include <optional>
+#include <ostream>
+#include <vector>
+
+// matched entries compared at once by a worker
+constexpr std::size_t DIFF_BLOCK_SIZE = 4096;
+
+struct ChangedEntry
+{
+    std::size_t oldEntry;
+    std::size_t newEntry;
+    std::vector<std::size_t> fields; // that differ, in the order of the structure
+};
+
+struct TableDiff
+{
+    std::vector<std::size_t> removed; // entries of the old table
+    std::vector<std::size_t> added;   // entries of the new table
+    std::vector<ChangedEntry> changed;
+};
+
+/*
+ * Compares two versions of a table record by record. Entries are matched by the value of the key field, or by their
+ * position without one. Entries sharing a key get matched in file order. The fields of matched entries are compared
+ * bit for bit, blocks of entries on multiple threads.
+ */
+TableDiff
+diffTables(const Table& oldTable, const Table& newTable, std::optional<std::size_t> keyField, std::size_t threadCount);
+
+/*
+ * One line per removed and added entry and per changed field:
+ *   change,oldEntry,newEntry,<keyField>,field,old,new,delta
+ * The key column only exists with a key field, the delta only for numeric fields.
+ */
+void writeDiffCSV(std::ostream& stream,
+                  const Table& oldTable,
+                  const Table& newTable,
+                  const TableDiff& diff,
+                  std::optional<std::size_t> keyField);
+
+// the same as writeDiffCSV as an object of "removed", "added" and "changed" lists
+void writeDiffJson(std::ostream& stream,
+                   const Table& oldTable,
+                   const Table& newTable,
+                   const TableDiff& diff,
+                   std::optional<std::size_t> keyField);
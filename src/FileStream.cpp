@@ -0,0 +1,247 @@
+#include "FileStream.hpp"
+
+#include "CompressedStream.hpp"
+#include "OutputBuffer.hpp"
+
+#ifdef BDC_IO_URING
+    #include "UringStream.hpp"
+#endif
+#ifdef BDC_MMAP
+    #include "MappedStream.hpp"
+#endif
+#include "PipelineStream.hpp"
+#include "Trace.hpp"
+#include "UnityBundle.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+constexpr std::size_t URING_BLOCK_SIZE  = 1024 * 1024;
+constexpr std::size_t URING_BLOCK_COUNT = 3;
+
+bool isPipelined(const boost::json::object& config)
+{
+    auto pipeline = config.if_contains("pipeline");
+    return pipeline && pipeline->is_bool() && pipeline->as_bool();
+}
+
+bool isBackendRequested(const boost::json::object& config, const std::string& backend)
+{
+    auto io = config.if_contains("io");
+    return io && io->is_string() && boost::algorithm::iequals(std::string(io->as_string()), backend);
+}
+
+std::unique_ptr<std::streambuf>
+openFileInputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+{
+#ifdef BDC_IO_URING
+    try
+    {
+        if (isBackendRequested(config, "uring"))
+            return std::make_unique<UringReadBuffer>(path, URING_BLOCK_SIZE, URING_BLOCK_COUNT);
+    }
+    catch (std::runtime_error&)
+    {
+        // fall back to the regular file buffer
+    }
+#endif
+#ifdef BDC_MMAP
+    try
+    {
+        if (isBackendRequested(config, "mmap")) return std::make_unique<MappedReadBuffer>(openMappedFile(path));
+    }
+    catch (std::runtime_error&)
+    {
+        // fall back to the regular file buffer
+    }
+#endif
+
+    auto buffer = std::make_unique<std::filebuf>();
+    if (!buffer->open(path, mode | std::ios::in)) throw std::runtime_error("Could not open file: " + path);
+
+    return buffer;
+}
+
+std::unique_ptr<std::streambuf>
+openFileOutputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+{
+#ifdef BDC_IO_URING
+    try
+    {
+        if (isBackendRequested(config, "uring"))
+            return std::make_unique<UringWriteBuffer>(path, URING_BLOCK_SIZE, URING_BLOCK_COUNT);
+    }
+    catch (std::runtime_error&)
+    {
+        // fall back to the regular file buffer
+    }
+#endif
+#ifdef BDC_MMAP
+    try
+    {
+        if (!config.contains("io") || isBackendRequested(config, "mmap"))
+        {
+            auto sizeHint = config.if_contains("sizeHint");
+            return std::make_unique<MappedWriteBuffer>(path, sizeHint ? sizeHint->to_number<uint64_t>() : 0);
+        }
+    }
+    catch (std::runtime_error&)
+    {
+        // fall back to the regular file buffer
+    }
+#endif
+
+    auto buffer = std::make_unique<std::filebuf>();
+    if (!buffer->open(path, mode | std::ios::out)) throw std::runtime_error("Could not open file: " + path);
+
+    return buffer;
+}
+
+// AssetStudio exports TextAssets with the extension of their original file, which isn't part of their name
+std::string getAssetName(const UnityBundle& bundle, const std::string& path)
+{
+    auto fileName = std::filesystem::path(path).filename();
+    return bundle.hasTextAsset(fileName.string()) ? fileName.string() : fileName.stem().string();
+}
+
+std::unique_ptr<std::streambuf>
+openContentInputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+{
+    if (auto bundlePath = config.if_contains("bundle"))
+    {
+        auto bundle = openBundle(std::string(bundlePath->as_string()));
+        return std::make_unique<BundleAssetBuffer>(bundle, getAssetName(*bundle, path));
+    }
+
+    auto compression = getCompression(config, path);
+    if (compression == Compression::NONE) return openFileInputBuffer(config, path, mode);
+
+    auto fileBuffer = openFileInputBuffer(config, path, std::ios::binary);
+    return std::make_unique<DecompressingBuffer>(std::move(fileBuffer), compression);
+}
+
+std::unique_ptr<std::streambuf>
+openInputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+{
+    auto buffer = openContentInputBuffer(config, path, mode);
+    if (isPipelined(config)) return std::make_unique<PrefetchingBuffer>(std::move(buffer));
+
+    return buffer;
+}
+
+bool inputExists(const boost::json::object& config, const std::string& path)
+{
+    if (auto bundlePath = config.if_contains("bundle"))
+    {
+        auto bundle = openBundle(std::string(bundlePath->as_string()));
+        return bundle->hasTextAsset(getAssetName(*bundle, path));
+    }
+
+    return std::filesystem::exists(path);
+}
+
+std::unique_ptr<std::streambuf> openOutputBuffer(const boost::json::object& config,
+                                                 const std::string& path,
+                                                 std::ios::openmode mode,
+                                                 Compression compression)
+{
+    std::unique_ptr<std::streambuf> buffer;
+    if (compression == Compression::NONE)
+        buffer = openFileOutputBuffer(config, path, mode);
+    else
+        buffer = std::make_unique<CompressingBuffer>(openFileOutputBuffer(config, path, std::ios::binary), compression);
+
+    if (isPipelined(config)) return std::make_unique<WriteBehindBuffer>(std::move(buffer));
+
+    return buffer;
+}
+
+std::unique_ptr<std::streambuf>
+openOutputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+{
+    return openOutputBuffer(config, path, mode, getCompression(config, path));
+}
+
+bool finishOutputBuffer(std::streambuf& buffer)
+{
+    if (auto output = dynamic_cast<OutputBuffer*>(&buffer)) return output->finish();
+    if (auto file = dynamic_cast<std::filebuf*>(&buffer)) return !file->is_open() || file->close() != nullptr;
+
+    return buffer.pubsync() == 0;
+}
+
+// flushes the file to the disk, so a rename can't make it visible before its contents
+bool syncFile(const std::string& path)
+{
+#ifdef _WIN32
+    auto fileFd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fileFd < 0) return false;
+
+    bool isSynced = _commit(fileFd) == 0;
+    _close(fileFd);
+#else
+    auto fileFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileFd < 0) return false;
+
+    bool isSynced = fsync(fileFd) == 0;
+    close(fileFd);
+#endif
+    return isSynced;
+}
+
+/* Output File */
+OutputFile::OutputFile(const boost::json::object& config, const std::string& path, std::ios::openmode mode)
+    : path(path)
+{
+    if (!std::filesystem::exists(path) || std::filesystem::is_regular_file(path)) tempPath = path + ".tmp";
+
+    // the temporary file has no extension to detect the compression from
+    buffer = openOutputBuffer(config, tempPath.empty() ? path : tempPath, mode, getCompression(config, path));
+}
+
+OutputFile::~OutputFile()
+{
+    if (!buffer) return;
+
+    buffer.reset();
+    std::error_code error;
+    if (!tempPath.empty()) std::filesystem::remove(tempPath, error);
+}
+
+std::streambuf* OutputFile::get() const { return buffer.get(); }
+
+void OutputFile::commit()
+{
+    if (!buffer) return;
+
+    TraceSpan span("flush", path);
+
+    // compressed trailers and the final size of mapped files are only written when the buffer is finished
+    bool isWritten = buffer->pubsync() == 0;
+    isWritten      = finishOutputBuffer(*buffer) && isWritten;
+    buffer.reset();
+    if (tempPath.empty())
+    {
+        if (!isWritten) throw std::runtime_error("Could not write file: " + path);
+        return;
+    }
+
+    std::error_code error;
+    isWritten = isWritten && syncFile(tempPath);
+    if (isWritten) std::filesystem::rename(tempPath, path, error);
+    if (!isWritten || error)
+    {
+        std::filesystem::remove(tempPath, error);
+        throw std::runtime_error("Could not write file: " + path);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <boost/json.hpp>
+
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+/*
+ * Opens the stream buffer backing a channel's file. The "io" key of the channel config selects the backend:
+ * "std" uses std::filebuf, "uring" uses io_uring with read-ahead and write-behind on Linux, "mmap" also reads input
+ * files through a read-only memory mapping shared by all readers of the file on POSIX systems. By default output files
+ * are written through a memory mapping on POSIX systems, preallocated to the "sizeHint" key of the config.
+ * Backends that aren't available fall back to std::filebuf. With the "pipeline" key, the data is read ahead or written
+ * behind on a thread of its own, on top of any backend and compression.
+ */
+std::unique_ptr<std::streambuf>
+openInputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode);
+
+/*
+ * With the "bundle" key of the channel config, input files are read from the TextAssets of that UnityFS bundle
+ * instead, named like the file with or without its extension.
+ */
+bool inputExists(const boost::json::object& config, const std::string& path);
+std::unique_ptr<std::streambuf>
+openOutputBuffer(const boost::json::object& config, const std::string& path, std::ios::openmode mode);
+
+/*
+ * A file that gets written next to its target and only replaces it once committed, so a failed run never leaves a
+ * partially written file behind. Uncommitted files get removed. Targets that aren't regular files, like pipes,
+ * are written directly.
+ */
+class OutputFile
+{
+    std::string path;
+    std::string tempPath;
+    std::unique_ptr<std::streambuf> buffer;
+
+public:
+    OutputFile(const boost::json::object& config, const std::string& path, std::ios::openmode mode);
+    ~OutputFile();
+
+    OutputFile(const OutputFile&)            = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    std::streambuf* get() const;
+    void commit();
+};
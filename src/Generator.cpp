@@ -0,0 +1,334 @@
+#include "Generator.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+Distribution toDistribution(std::string name)
+{
+    static const std::map<std::string, Distribution> distributions = {
+        { "uniform", Distribution::UNIFORM },
+        { "normal", Distribution::NORMAL },
+        { "sequential", Distribution::SEQUENTIAL },
+        { "zipf", Distribution::ZIPF },
+    };
+
+    boost::algorithm::to_lower(name);
+    auto it = distributions.find(name);
+    if (it == distributions.end()) throw std::runtime_error("Unknown distribution: " + name);
+
+    return it->second;
+}
+
+FieldGenerator getFieldGenerator(const boost::json::object& config, FieldGenerator defaults)
+{
+    if (auto value = config.if_contains("distribution"))
+        defaults.distribution = toDistribution(std::string(value->as_string()));
+    if (auto value = config.if_contains("decimals")) defaults.decimals = value->to_number<int32_t>();
+
+    if (auto value = config.if_contains("min")) defaults.min = value->to_number<double>();
+    if (auto value = config.if_contains("max")) defaults.max = value->to_number<double>();
+
+    if (auto value = config.if_contains("length"))
+    {
+        auto& length       = value->as_array();
+        defaults.minLength = length.at(0).to_number<std::size_t>();
+        defaults.maxLength = length.at(1).to_number<std::size_t>();
+    }
+
+    if (auto value = config.if_contains("size"))
+    {
+        auto& size       = value->as_array();
+        defaults.minSize = size.at(0).to_number<std::size_t>();
+        defaults.maxSize = size.at(1).to_number<std::size_t>();
+    }
+
+    if (defaults.min > defaults.max) throw std::runtime_error("Generator min must not be larger than max.");
+    if (defaults.minLength > defaults.maxLength || defaults.minSize > defaults.maxSize)
+        throw std::runtime_error("Generator minimum length must not be larger than the maximum length.");
+
+    return defaults;
+}
+
+/* Random */
+Random::Random(uint64_t seed)
+{
+    // splitmix64, so similar seeds still produce unrelated states
+    for (auto& value : state)
+    {
+        seed += 0x9E3779B97F4A7C15ull;
+        uint64_t z = seed;
+        z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        value      = z ^ (z >> 31);
+    }
+}
+
+uint64_t Random::next()
+{
+    auto rotate = [](uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); };
+
+    uint64_t result = rotate(state[1] * 5, 7) * 9;
+    uint64_t t      = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotate(state[3], 45);
+
+    return result;
+}
+
+double Random::nextDouble() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+/* Data Generator */
+namespace
+{
+    // the full range of a number or of the elements of an array
+    std::pair<double, double> getTypeRange(FieldType type)
+    {
+        switch (type)
+        {
+            case FieldType::INT8: return { -128.0, 127.0 };
+            case FieldType::INT16: return { -32768.0, 32767.0 };
+            // the sign-magnitude encoding can't store -2^23
+            case FieldType::INT24:
+            case FieldType::INT24ARRAY: return { -8388607.0, 8388607.0 };
+            case FieldType::INT32:
+            case FieldType::INT32ARRAY: return { -2147483648.0, 2147483647.0 };
+            case FieldType::UINT8:
+            case FieldType::HEX8: return { 0.0, 255.0 };
+            case FieldType::UINT16:
+            case FieldType::HEX16: return { 0.0, 65535.0 };
+            case FieldType::UINT24:
+            case FieldType::UINT24ARRAY: return { 0.0, 16777215.0 };
+            case FieldType::UINT32:
+            case FieldType::HEX32:
+            case FieldType::UINT32ARRAY: return { 0.0, 4294967295.0 };
+            // small enough for DECIMAL24 to find the two decimals despite the float rounding
+            case FieldType::FLOAT:
+            case FieldType::DOUBLE:
+            case FieldType::FLOATARRAY:
+            case FieldType::DOUBLEARRAY: return { -100.0, 100.0 };
+            default: return { 0.0, 0.0 };
+        }
+    }
+
+    FieldType getElementType(FieldType type)
+    {
+        switch (type)
+        {
+            case FieldType::INT24ARRAY: return FieldType::INT24;
+            case FieldType::INT32ARRAY: return FieldType::INT32;
+            case FieldType::UINT24ARRAY: return FieldType::UINT24;
+            case FieldType::UINT32ARRAY: return FieldType::UINT32;
+            case FieldType::FLOATARRAY: return FieldType::FLOAT;
+            case FieldType::DOUBLEARRAY: return FieldType::DOUBLE;
+            default: return type;
+        }
+    }
+
+    bool isFloatingPoint(FieldType type)
+    {
+        return type == FieldType::FLOAT || type == FieldType::DOUBLE || type == FieldType::FLOATARRAY ||
+               type == FieldType::DOUBLEARRAY;
+    }
+
+    // no separators or quotes, so strings need no escaping in CSV files and string tables
+    constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_-";
+    static_assert(sizeof(ALPHABET) - 1 == 64);
+} // namespace
+
+DataGenerator::DataGenerator(const Structure& structure,
+                             const boost::json::object& overrides,
+                             const FieldGenerator& defaults,
+                             uint64_t seed)
+    : random(seed)
+{
+    for (auto& field : structure.getFields())
+    {
+        auto override  = overrides.if_contains(field.name);
+        auto generator = override ? getFieldGenerator(override->as_object(), defaults) : defaults;
+
+        auto [typeMin, typeMax] = getTypeRange(field.type);
+        double min              = std::clamp(generator.min, typeMin, typeMax);
+        double max              = std::clamp(generator.max, typeMin, typeMax);
+
+        double scale = isFloatingPoint(field.type) ? std::pow(10.0, generator.decimals) : 0.0;
+        columns.push_back({ field, generator, min, max, scale });
+    }
+}
+
+double DataGenerator::nextValue(const Column& column)
+{
+    // integers are sampled from [min, max + 1) and rounded down
+    double range = column.max - column.min + (column.scale == 0.0 ? 1.0 : 0.0);
+
+    switch (column.generator.distribution)
+    {
+        case Distribution::UNIFORM: return column.min + random.nextDouble() * range;
+        case Distribution::NORMAL:
+        {
+            double radius = std::sqrt(-2.0 * std::log(1.0 - random.nextDouble()));
+            double angle  = 2.0 * std::numbers::pi * random.nextDouble();
+            return column.min + range / 2.0 + radius * std::cos(angle) * range / 6.0;
+        }
+        case Distribution::SEQUENTIAL:
+            return column.min + std::fmod(static_cast<double>(currentEntry), std::max(range, 1.0));
+        case Distribution::ZIPF: return column.min + std::pow(range + 1.0, random.nextDouble()) - 1.0;
+    }
+
+    return column.min;
+}
+
+std::size_t DataGenerator::nextLength(std::size_t min, std::size_t max)
+{
+    return min + random.next() % (max - min + 1);
+}
+
+template<typename T> T DataGenerator::nextNumber(const Column& column)
+{
+    double value = nextValue(column);
+
+    if constexpr (std::is_floating_point_v<T>)
+        value = std::round(value * column.scale) / column.scale;
+    else
+        value = std::floor(value);
+
+    return static_cast<T>(std::clamp(value, column.min, column.max));
+}
+
+template<typename T> void DataGenerator::fillArray(const Column& column, std::vector<T>& values)
+{
+    values.resize(nextLength(column.generator.minSize, column.generator.maxSize));
+    for (auto& value : values)
+        value = nextNumber<T>(column);
+}
+
+void DataGenerator::limitDistinctStrings(std::size_t count)
+{
+    auto stringColumns = std::count_if(columns.begin(),
+                                       columns.end(),
+                                       [](auto& column) { return column.field.type == FieldType::STRING; });
+    if (stringColumns != 0) stringPoolSize = std::max<std::size_t>(1, count / stringColumns);
+}
+
+void DataGenerator::fillString(Column& column)
+{
+    auto& pool = column.stringPool;
+    if (stringPoolSize != 0 && pool.size() == stringPoolSize)
+    {
+        stringBuffer = pool[random.next() % pool.size()];
+        return;
+    }
+
+    stringBuffer.resize(nextLength(column.generator.minLength, column.generator.maxLength));
+
+    // every random number provides the characters for 10 positions
+    uint64_t bits      = 0;
+    std::size_t unused = 0;
+    for (auto& character : stringBuffer)
+    {
+        if (unused == 0)
+        {
+            bits   = random.next();
+            unused = 10;
+        }
+
+        character = ALPHABET[bits & 63];
+        bits >>= 6;
+        unused--;
+    }
+
+    if (stringPoolSize != 0) pool.push_back(stringBuffer);
+}
+
+void DataGenerator::writeEntry(Writer& writer)
+{
+    writer.startEntry();
+
+    for (auto& column : columns)
+    {
+        auto& name = column.field.name;
+
+        switch (column.field.type)
+        {
+            case FieldType::INT8: writer.writeInt8(name, nextNumber<int8_t>(column)); break;
+            case FieldType::INT16: writer.writeInt16(name, nextNumber<int16_t>(column)); break;
+            case FieldType::INT24: writer.writeInt24(name, nextNumber<int32_t>(column)); break;
+            case FieldType::INT32: writer.writeInt32(name, nextNumber<int32_t>(column)); break;
+            case FieldType::UINT8: writer.writeUInt8(name, nextNumber<uint8_t>(column)); break;
+            case FieldType::UINT16: writer.writeUInt16(name, nextNumber<uint16_t>(column)); break;
+            case FieldType::UINT24: writer.writeUInt24(name, nextNumber<uint32_t>(column)); break;
+            case FieldType::UINT32: writer.writeUInt32(name, nextNumber<uint32_t>(column)); break;
+            case FieldType::HEX8: writer.writeHex8(name, nextNumber<uint8_t>(column)); break;
+            case FieldType::HEX16: writer.writeHex16(name, nextNumber<uint16_t>(column)); break;
+            case FieldType::HEX32: writer.writeHex32(name, nextNumber<uint32_t>(column)); break;
+            case FieldType::FLOAT: writer.writeFloat(name, nextNumber<float>(column)); break;
+            case FieldType::DOUBLE: writer.writeDouble(name, nextNumber<double>(column)); break;
+            case FieldType::STRING:
+                fillString(column);
+                writer.writeString(name, stringBuffer);
+                break;
+            case FieldType::INT24ARRAY:
+                fillArray(column, intBuffer);
+                writer.writeInt24Array(name, intBuffer);
+                break;
+            case FieldType::INT32ARRAY:
+                fillArray(column, intBuffer);
+                writer.writeInt32Array(name, intBuffer);
+                break;
+            case FieldType::UINT24ARRAY:
+                fillArray(column, uintBuffer);
+                writer.writeUInt24Array(name, uintBuffer);
+                break;
+            case FieldType::UINT32ARRAY:
+                fillArray(column, uintBuffer);
+                writer.writeUInt32Array(name, uintBuffer);
+                break;
+            case FieldType::FLOATARRAY:
+                fillArray(column, floatBuffer);
+                writer.writeFloatArray(name, floatBuffer);
+                break;
+            case FieldType::DOUBLEARRAY:
+                fillArray(column, doubleBuffer);
+                writer.writeDoubleArray(name, doubleBuffer);
+                break;
+        }
+    }
+
+    writer.finishEntry();
+    currentEntry++;
+}
+
+std::size_t DataGenerator::getAverageEntrySize(const BinaryFormat& format) const
+{
+    std::size_t size = 0;
+    for (auto& column : columns)
+    {
+        auto type       = column.field.type;
+        auto& generator = column.generator;
+
+        if (auto fieldSize = getEncodedSize(format, type); fieldSize != 0)
+            size += fieldSize;
+        else if (type == FieldType::STRING)
+            size += (generator.minLength + generator.maxLength) / 2 + 1;
+        else
+        {
+            auto countType = getElementType(type) == FieldType::INT24 || getElementType(type) == FieldType::UINT24
+                                 ? FieldType::INT24
+                                 : FieldType::INT32;
+            size += getEncodedSize(format, countType) +
+                    (generator.minSize + generator.maxSize) / 2 * getEncodedSize(format, getElementType(type));
+        }
+    }
+
+    return size;
+}
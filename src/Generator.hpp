@@ -0,0 +1,110 @@
+#pragma once
+
+#include "BinaryChannel.hpp"
+#include "Channel.hpp"
+#include "Structure.hpp"
+
+#include <boost/json.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+enum class Distribution
+{
+    UNIFORM,
+    NORMAL,     // centered between min and max, 99.7% of the values fall inside
+    SEQUENTIAL, // min, min + 1, ... wrapping around after max
+    ZIPF,       // log-uniform, roughly Zipf with s = 1, small values are most common
+};
+
+Distribution toDistribution(std::string name);
+
+/*
+ * How the values of a single field are generated. min/max bound numbers and array elements, floats are rounded to
+ * the given decimals, so they survive the DECIMAL24 encoding and the CSV round trip unchanged.
+ */
+struct FieldGenerator
+{
+    Distribution distribution = Distribution::UNIFORM;
+    double min                = -std::numeric_limits<double>::infinity(); // clamped to the range of the field type
+    double max                = std::numeric_limits<double>::infinity();
+    int32_t decimals          = 2;
+    std::size_t minLength     = 4; // characters of strings
+    std::size_t maxLength     = 16;
+    std::size_t minSize       = 0; // elements of arrays
+    std::size_t maxSize       = 8;
+};
+
+/*
+ * Reads the "distribution", "min", "max", "decimals", "length" ([min, max]) and "size" ([min, max]) keys of the
+ * config, everything missing is taken from the defaults.
+ */
+FieldGenerator getFieldGenerator(const boost::json::object& config, FieldGenerator defaults);
+
+// xoshiro256**, fast and with a fixed output for every seed on every platform
+class Random
+{
+    uint64_t state[4];
+
+public:
+    Random(uint64_t seed);
+
+    uint64_t next();
+    double nextDouble(); // [0, 1)
+};
+
+/*
+ * Writes entries with random contents for the given structure. The same seed always produces the same entries.
+ */
+class DataGenerator
+{
+    struct Column
+    {
+        Field field;
+        FieldGenerator generator;
+        double min;
+        double max;
+        double scale; // 10^decimals, 0 for integers
+        std::vector<std::string> stringPool{};
+    };
+
+    std::vector<Column> columns{};
+    Random random;
+    std::size_t currentEntry   = 0;
+    std::size_t stringPoolSize = 0; // distinct strings per field, unlimited for 0
+
+    std::string stringBuffer{};
+    std::vector<int32_t> intBuffer{};
+    std::vector<uint32_t> uintBuffer{};
+    std::vector<float> floatBuffer{};
+    std::vector<double> doubleBuffer{};
+
+    double nextValue(const Column& column);
+    std::size_t nextLength(std::size_t min, std::size_t max);
+    template<typename T> T nextNumber(const Column& column);
+    template<typename T> void fillArray(const Column& column, std::vector<T>& values);
+    void fillString(Column& column);
+
+public:
+    /*
+     * Per field overrides are read from the object of the same name in the overrides config,
+     * e.g. { "hpMax": { "distribution": "normal", "min": 1, "max": 999 } }.
+     */
+    DataGenerator(const Structure& structure,
+                  const boost::json::object& overrides,
+                  const FieldGenerator& defaults,
+                  uint64_t seed);
+
+    /*
+     * Keeps the distinct strings of all fields together within the given count, e.g. the capacity of a string table.
+     * Every field generates its share of new strings first and repeats them afterwards.
+     */
+    void limitDistinctStrings(std::size_t count);
+
+    void writeEntry(Writer& writer);
+
+    // average size of the generated entries in the given format
+    std::size_t getAverageEntrySize(const BinaryFormat& format) const;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+constexpr uint64_t FNV_PRIME        = 0x00000100000001B3ull;
+
+// FNV-1a, used for anything that gets persisted and must therefore be stable
+inline uint64_t fnv1a(const void* data, std::size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (std::size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+
+    return hash;
+}
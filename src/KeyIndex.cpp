@@ -0,0 +1,276 @@
+#include "KeyIndex.hpp"
+
+#include "FileStream.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+constexpr std::array<char, 8> KEY_INDEX_MAGIC = { 'B', 'D', 'C', 'K', 'E', 'Y', '0', '2' };
+constexpr uint64_t EMPTY_SLOT                 = std::numeric_limits<uint64_t>::max();
+constexpr int64_t INT24_MIN                   = -(int64_t(1) << 23);
+constexpr int64_t INT24_MAX                   = (int64_t(1) << 23) - 1;
+constexpr uint64_t UINT24_MAX                 = (uint64_t(1) << 24) - 1;
+
+namespace
+{
+    // spreads sequential ids over the whole table
+    uint64_t mixKey(uint64_t key)
+    {
+        key ^= key >> 30;
+        key *= 0xBF58476D1CE4E5B9ull;
+        key ^= key >> 27;
+        key *= 0x94D049BB133111EBull;
+        return key ^ (key >> 31);
+    }
+
+    uint64_t readKey(Reader& reader, FieldType type, std::pmr::string& scratch)
+    {
+        switch (type)
+        {
+            case FieldType::INT8: return static_cast<uint64_t>(static_cast<int64_t>(reader.readInt8()));
+            case FieldType::INT16: return static_cast<uint64_t>(static_cast<int64_t>(reader.readInt16()));
+            case FieldType::INT24: return static_cast<uint64_t>(static_cast<int64_t>(reader.readInt24()));
+            case FieldType::INT32: return static_cast<uint64_t>(static_cast<int64_t>(reader.readInt32()));
+            case FieldType::UINT8: return reader.readUInt8();
+            case FieldType::UINT16: return reader.readUInt16();
+            case FieldType::UINT24: return reader.readUInt24();
+            case FieldType::UINT32: return reader.readUInt32();
+            case FieldType::HEX8: return reader.readHex8();
+            case FieldType::HEX16: return reader.readHex16();
+            case FieldType::HEX32: return reader.readHex32();
+            default: reader.readString(scratch); return fnv1a(scratch.data(), scratch.size());
+        }
+    }
+
+    struct KeyIndexHeader
+    {
+        std::array<char, 8> magic;
+        FileFingerprint fingerprint;
+        uint64_t keyField;
+        uint64_t entryCount;
+        uint64_t slotCount;
+    };
+
+    bool readHeader(std::istream& stream, KeyIndexHeader& header, const FileFingerprint& expected, std::size_t keyField)
+    {
+        stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        return stream && header.magic == KEY_INDEX_MAGIC && header.fingerprint == expected &&
+               header.keyField == keyField && std::has_single_bit(header.slotCount);
+    }
+} // namespace
+
+void checkKeyField(const Field& field)
+{
+    switch (field.type)
+    {
+        case FieldType::FLOAT:
+        case FieldType::DOUBLE:
+        case FieldType::INT24ARRAY:
+        case FieldType::INT32ARRAY:
+        case FieldType::UINT24ARRAY:
+        case FieldType::UINT32ARRAY:
+        case FieldType::FLOATARRAY:
+        case FieldType::DOUBLEARRAY:
+            throw std::runtime_error("Only integer and string fields can be keys: " + field.name);
+        default: break;
+    }
+}
+
+uint64_t parseKey(const Field& field, const std::string& value)
+{
+    checkKeyField(field);
+
+    // a key the field can't store would never be found, unsigned fields reject negative keys while parsing
+    auto parse = [&](auto min, auto max, int base)
+    {
+        auto begin = value.data();
+        auto end   = value.data() + value.size();
+        if (base == 16 && value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) begin += 2;
+
+        decltype(max) number = 0;
+        auto result          = std::from_chars(begin, end, number, base);
+        if (result.ec != std::errc() || result.ptr != end)
+            throw std::runtime_error("Invalid key for " + field.name + ": " + value);
+        if (number < min || number > max)
+            throw std::runtime_error("Key out of range for " + field.name + " (" + field.typeName + "): " + value);
+
+        return static_cast<uint64_t>(number);
+    };
+
+    switch (field.type)
+    {
+        case FieldType::INT8: return parse(int64_t(INT8_MIN), int64_t(INT8_MAX), 10);
+        case FieldType::INT16: return parse(int64_t(INT16_MIN), int64_t(INT16_MAX), 10);
+        case FieldType::INT24: return parse(int64_t(INT24_MIN), int64_t(INT24_MAX), 10);
+        case FieldType::INT32: return parse(int64_t(INT32_MIN), int64_t(INT32_MAX), 10);
+        case FieldType::UINT8: return parse(uint64_t(0), uint64_t(UINT8_MAX), 10);
+        case FieldType::UINT16: return parse(uint64_t(0), uint64_t(UINT16_MAX), 10);
+        case FieldType::UINT24: return parse(uint64_t(0), uint64_t(UINT24_MAX), 10);
+        case FieldType::UINT32: return parse(uint64_t(0), uint64_t(UINT32_MAX), 10);
+        case FieldType::HEX8: return parse(uint64_t(0), uint64_t(UINT8_MAX), 16);
+        case FieldType::HEX16: return parse(uint64_t(0), uint64_t(UINT16_MAX), 16);
+        case FieldType::HEX32: return parse(uint64_t(0), uint64_t(UINT32_MAX), 16);
+        default: return fnv1a(value.data(), value.size());
+    }
+}
+
+void removeHashCollisions(std::vector<KeyEntry>& entries,
+                          Reader& reader,
+                          const Structure& structure,
+                          std::size_t keyField,
+                          std::string_view value)
+{
+    auto& fields = structure.getFields();
+    if (fields.at(keyField).type != FieldType::STRING) return;
+
+    std::pmr::string scratch;
+    auto isOther = [&](const KeyEntry& entry)
+    {
+        reader.setPosition(entry.offset);
+        for (std::size_t i = 0; i < keyField; i++)
+            reader.skip(fields[i].type);
+
+        reader.readString(scratch);
+        return std::string_view(scratch) != value;
+    };
+    std::erase_if(entries, isOther);
+}
+
+KeyIndex::KeyIndex(FileFingerprint fingerprint, std::size_t keyField)
+    : fingerprint(fingerprint)
+    , keyField(keyField)
+{
+}
+
+void KeyIndex::insert(uint64_t key, uint64_t entry, uint64_t offset)
+{
+    auto mask = slots.size() - 1;
+    auto slot = mixKey(key) & mask;
+    while (slots[slot].entry != EMPTY_SLOT)
+        slot = (slot + 1) & mask;
+
+    slots[slot] = { key, entry, offset };
+}
+
+KeyIndex
+KeyIndex::build(Reader& reader, const Structure& structure, std::size_t keyField, FileFingerprint fingerprint)
+{
+    auto& fields = structure.getFields();
+    checkKeyField(fields.at(keyField));
+
+    std::vector<std::pair<uint64_t, uint64_t>> keys; // key and offset of every record
+    std::pmr::string scratch;
+    reader.setPosition(fingerprint.startOffset);
+
+    while (reader.hasNext())
+    {
+        auto position = reader.getPosition();
+        if (position >= fingerprint.fileSize) break;
+
+        uint64_t key = 0;
+        for (std::size_t i = 0; i < fields.size(); i++)
+        {
+            if (i == keyField)
+                key = readKey(reader, fields[i].type, scratch);
+            else
+                reader.skip(fields[i].type);
+        }
+        keys.emplace_back(key, position);
+    }
+
+    KeyIndex index(fingerprint, keyField);
+    index.entryCount = keys.size();
+    index.slots.resize(std::bit_ceil(std::max<std::size_t>(keys.size() * 2, 16)), { 0, EMPTY_SLOT, 0 });
+    for (std::size_t entry = 0; entry < keys.size(); entry++)
+        index.insert(keys[entry].first, entry, keys[entry].second);
+
+    return index;
+}
+
+std::optional<KeyIndex>
+KeyIndex::load(const std::filesystem::path& path, const FileFingerprint& expected, std::size_t keyField)
+{
+    if (!std::filesystem::is_regular_file(path)) return std::nullopt;
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    KeyIndexHeader header;
+    if (!readHeader(stream, header, expected, keyField)) return std::nullopt;
+
+    KeyIndex index(header.fingerprint, keyField);
+    index.entryCount = header.entryCount;
+    index.slots.resize(header.slotCount);
+    stream.read(reinterpret_cast<char*>(index.slots.data()), index.slots.size() * sizeof(Slot));
+
+    if (!stream) return std::nullopt;
+
+    return index;
+}
+
+void KeyIndex::save(const std::filesystem::path& path) const
+{
+    KeyIndexHeader header{ KEY_INDEX_MAGIC, fingerprint, keyField, entryCount, slots.size() };
+
+    OutputFile file({}, path.string(), std::ios::out | std::ios::binary);
+    std::ostream stream(file.get());
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(Slot));
+
+    if (!stream) throw std::runtime_error("Could not write key index: " + path.string());
+    file.commit();
+}
+
+std::optional<std::vector<KeyEntry>> KeyIndex::find(const std::filesystem::path& path,
+                                                    const FileFingerprint& expected,
+                                                    std::size_t keyField,
+                                                    uint64_t key)
+{
+    if (!std::filesystem::is_regular_file(path)) return std::nullopt;
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    KeyIndexHeader header;
+    if (!readHeader(stream, header, expected, keyField)) return std::nullopt;
+
+    std::vector<KeyEntry> entries;
+    auto mask = header.slotCount - 1;
+    auto slot = mixKey(key) & mask;
+    stream.seekg(sizeof(header) + slot * sizeof(Slot));
+
+    // runs of slots are read sequentially, only the wrap around the end of the table seeks
+    uint64_t probes = 0;
+    for (Slot value; stream.read(reinterpret_cast<char*>(&value), sizeof(value)) && value.entry != EMPTY_SLOT;)
+    {
+        // a table without empty slots can only come from a corrupted file, probing it would never end
+        if (++probes > header.slotCount) throw std::runtime_error("Corrupted key index: " + path.string());
+        if (value.key == key) entries.push_back({ value.entry, value.offset });
+
+        slot = (slot + 1) & mask;
+        if (slot == 0) stream.seekg(sizeof(header));
+    }
+    if (!stream) return std::nullopt;
+
+    std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) { return a.entry < b.entry; });
+    return entries;
+}
+
+std::vector<KeyEntry> KeyIndex::find(uint64_t key) const
+{
+    std::vector<KeyEntry> entries;
+
+    auto mask = slots.size() - 1;
+    for (auto slot = mixKey(key) & mask; slots[slot].entry != EMPTY_SLOT; slot = (slot + 1) & mask)
+        if (slots[slot].key == key) entries.push_back({ slots[slot].entry, slots[slot].offset });
+
+    // probing wraps around the end of the table
+    std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) { return a.entry < b.entry; });
+    return entries;
+}
+
+std::size_t KeyIndex::getEntryCount() const { return entryCount; }
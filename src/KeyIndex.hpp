@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "RecordIndex.hpp"
+#include "Structure.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct KeyEntry
+{
+    uint64_t entry;  // record number
+    uint64_t offset; // byte offset of the record
+};
+
+/*
+ * Maps the values of a key field, usually the id, to the records containing them, so single records can be found
+ * without decoding the ones before them. An open-addressing hash table with linear probing, kept at most half full
+ * so lookups rarely probe more than a slot or two. The table is stored as is, so it can be probed in the file.
+ * Integer keys are stored as their value, string keys as their 64 bit hash.
+ */
+class KeyIndex
+{
+    struct Slot
+    {
+        uint64_t key;
+        uint64_t entry; // EMPTY_SLOT when unused
+        uint64_t offset;
+    };
+
+    FileFingerprint fingerprint;
+    uint64_t keyField;
+    uint64_t entryCount = 0;
+    std::vector<Slot> slots{};
+
+    void insert(uint64_t key, uint64_t entry, uint64_t offset);
+
+public:
+    KeyIndex(FileFingerprint fingerprint, std::size_t keyField);
+
+    static KeyIndex
+    build(Reader& reader, const Structure& structure, std::size_t keyField, FileFingerprint fingerprint);
+    static std::optional<KeyIndex>
+    load(const std::filesystem::path& path, const FileFingerprint& expected, std::size_t keyField);
+    void save(const std::filesystem::path& path) const;
+
+    // probes the stored table directly, only reading the slots a lookup touches, nothing when the index is outdated
+    static std::optional<std::vector<KeyEntry>>
+    find(const std::filesystem::path& path, const FileFingerprint& expected, std::size_t keyField, uint64_t key);
+
+    // every record with the key, in file order
+    std::vector<KeyEntry> find(uint64_t key) const;
+    std::size_t getEntryCount() const;
+};
+
+// throws for fields that can't be keys, which are all but integers and strings
+void checkKeyField(const Field& field);
+
+// the key of a value as written in the user file, e.g. "1D42993F" for hex fields
+uint64_t parseKey(const Field& field, const std::string& value);
+
+// string keys are found by their hash, this drops the records whose key field holds another string with the same hash
+void removeHashCollisions(std::vector<KeyEntry>& entries,
+                          Reader& reader,
+                          const Structure& structure,
+                          std::size_t keyField,
+                          std::string_view value);
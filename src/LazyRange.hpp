@@ -0,0 +1,112 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+/*
+ * Lazily evaluated range of the values a coroutine yields with co_yield. The coroutine only runs while the range is
+ * advanced, so a caller that stops early never pays for the rest. Yielded values are handed out by reference and
+ * only live until the next one is yielded, which lets the coroutine reuse their storage.
+ */
+template<typename T> class LazyRange : public std::ranges::view_base
+{
+public:
+    struct promise_type
+    {
+        const T* current = nullptr;
+        std::exception_ptr error;
+
+        LazyRange get_return_object() { return LazyRange(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        std::suspend_always yield_value(const T& value) noexcept
+        {
+            current = std::addressof(value);
+            return {};
+        }
+
+        // only yields, nothing to await
+        template<typename U> std::suspend_never await_transform(U&&) = delete;
+    };
+
+    class iterator
+    {
+        std::coroutine_handle<promise_type> coroutine = nullptr;
+
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type       = T;
+        using difference_type  = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> coroutine)
+            : coroutine(coroutine)
+        {
+        }
+
+        const T& operator*() const { return *coroutine.promise().current; }
+        const T* operator->() const { return coroutine.promise().current; }
+
+        iterator& operator++()
+        {
+            resume(coroutine);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t)
+        {
+            return !it.coroutine || it.coroutine.done();
+        }
+    };
+
+    LazyRange() = default;
+    LazyRange(LazyRange&& other) noexcept
+        : coroutine(std::exchange(other.coroutine, nullptr))
+    {
+    }
+    LazyRange& operator=(LazyRange&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (coroutine) coroutine.destroy();
+            coroutine = std::exchange(other.coroutine, nullptr);
+        }
+        return *this;
+    }
+    ~LazyRange()
+    {
+        if (coroutine) coroutine.destroy();
+    }
+
+    // single pass, begin runs the coroutine up to its first value
+    iterator begin()
+    {
+        if (coroutine && !coroutine.done() && !coroutine.promise().current) resume(coroutine);
+        return iterator(coroutine);
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+    std::coroutine_handle<promise_type> coroutine = nullptr;
+
+    explicit LazyRange(std::coroutine_handle<promise_type> coroutine)
+        : coroutine(coroutine)
+    {
+    }
+
+    // errors of the coroutine surface where it was resumed
+    static void resume(std::coroutine_handle<promise_type> coroutine)
+    {
+        coroutine.resume();
+        if (auto error = std::exchange(coroutine.promise().error, nullptr)) std::rethrow_exception(error);
+    }
+};
@@ -0,0 +1,225 @@
+#include "MappedStream.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint64_t MIN_MAPPING_SIZE = 1024 * 1024;
+
+/* Mapped File */
+MappedFile::MappedFile(const std::string& path)
+{
+    auto fileFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileFd < 0) throw std::runtime_error("Could not open file: " + path);
+
+    struct stat info;
+    bool isMapped = fstat(fileFd, &info) == 0 && S_ISREG(info.st_mode);
+    if (isMapped && info.st_size > 0)
+    {
+        auto mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileFd, 0);
+        isMapped     = mapping != MAP_FAILED;
+        if (isMapped)
+        {
+            data = static_cast<const char*>(mapping);
+            size = static_cast<uint64_t>(info.st_size);
+        }
+    }
+    close(fileFd);
+
+    if (!isMapped) throw std::runtime_error("Could not map file: " + path);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+const char* MappedFile::getData() const { return data; }
+uint64_t MappedFile::getSize() const { return size; }
+
+std::shared_ptr<MappedFile> openMappedFile(const std::string& path)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<MappedFile>> files;
+
+    std::lock_guard lock(mutex);
+    auto& entry = files[std::filesystem::absolute(path).string()];
+    auto file   = entry.lock();
+    if (!file)
+    {
+        file  = std::make_shared<MappedFile>(path);
+        entry = file;
+    }
+
+    return file;
+}
+
+/* Mapped Read Buffer */
+MappedReadBuffer::MappedReadBuffer(std::shared_ptr<MappedFile> file)
+    : file(file)
+{
+    auto begin = const_cast<char*>(file->getData());
+    setg(begin, begin, begin + file->getSize());
+}
+
+MappedReadBuffer::pos_type MappedReadBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::cur) offset += gptr() - eback();
+    if (dir == std::ios::end) offset += egptr() - eback();
+
+    return seekpos(pos_type(offset), which);
+}
+
+MappedReadBuffer::pos_type MappedReadBuffer::seekpos(pos_type position, std::ios::openmode which)
+{
+    if (!(which & std::ios::in) || position < 0 || position > egptr() - eback()) return pos_type(off_type(-1));
+
+    setg(eback(), eback() + off_type(position), egptr());
+    return position;
+}
+
+/* Mapped Write Buffer */
+
+MappedWriteBuffer::MappedWriteBuffer(const std::string& path, uint64_t sizeHint)
+{
+    fileFd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fileFd < 0) throw std::runtime_error("Could not open file: " + path);
+
+    struct stat info;
+    if (fstat(fileFd, &info) != 0 || !S_ISREG(info.st_mode) || !reserve(std::max(sizeHint, MIN_MAPPING_SIZE)))
+    {
+        close(fileFd);
+        throw std::runtime_error("Could not map file: " + path);
+    }
+}
+
+MappedWriteBuffer::~MappedWriteBuffer() { finish(); }
+
+bool MappedWriteBuffer::finish()
+{
+    if (fileFd < 0) return !hasError;
+
+    sync();
+    unmap();
+    if (ftruncate(fileFd, static_cast<off_t>(fileSize)) != 0) hasError = true;
+    if (close(fileFd) != 0) hasError = true;
+    fileFd = -1;
+    return !hasError;
+}
+
+uint64_t MappedWriteBuffer::getPosition() const { return static_cast<uint64_t>(pptr() - data); }
+
+// grows the file and its mapping to at least the given size, keeping the current position
+bool MappedWriteBuffer::reserve(uint64_t size)
+{
+    if (size <= capacity) return true;
+
+    // the mapping is gone after a failure, later writes would start over at the beginning of the file
+    if (remap(std::max(size, capacity * 2))) return true;
+
+    hasError = true;
+    return false;
+}
+
+bool MappedWriteBuffer::remap(uint64_t newSize)
+{
+    uint64_t position = data ? getPosition() : 0;
+
+    unmap();
+
+    // allocates all blocks at once where supported, which keeps the file from fragmenting
+#ifdef __linux__
+    // a full disk must fail here, writing into the mapping of a sparse file without space would raise SIGBUS
+    auto result = posix_fallocate(fileFd, 0, static_cast<off_t>(newSize));
+    if (result != 0 && result != EOPNOTSUPP && result != EINVAL) return false;
+    bool isAllocated = result == 0;
+#else
+    bool isAllocated = false;
+#endif
+    if (!isAllocated && ftruncate(fileFd, static_cast<off_t>(newSize)) != 0) return false;
+
+    auto mapping = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileFd, 0);
+    if (mapping == MAP_FAILED) return false;
+
+    data     = static_cast<char*>(mapping);
+    capacity = newSize;
+    setp(data + position, data + capacity);
+    return true;
+}
+
+void MappedWriteBuffer::unmap()
+{
+    if (!data) return;
+
+    fileSize = std::max(fileSize, getPosition());
+    munmap(data, capacity);
+    data     = nullptr;
+    capacity = 0;
+    setp(nullptr, nullptr);
+}
+
+MappedWriteBuffer::int_type MappedWriteBuffer::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+    if (hasError || !reserve(capacity + 1))
+    {
+        hasError = true;
+        return traits_type::eof();
+    }
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize MappedWriteBuffer::xsputn(const char* values, std::streamsize count)
+{
+    if (epptr() - pptr() < count && (hasError || !reserve(getPosition() + count)))
+    {
+        hasError = true;
+        return 0;
+    }
+
+    std::memcpy(pptr(), values, count);
+    // pbump only takes an int
+    setp(pptr() + count, epptr());
+    return count;
+}
+
+int MappedWriteBuffer::sync()
+{
+    if (data) fileSize = std::max(fileSize, getPosition());
+    return hasError ? -1 : 0;
+}
+
+MappedWriteBuffer::pos_type
+MappedWriteBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (!(which & std::ios::out)) return pos_type(off_type(-1));
+    if (dir == std::ios::cur) offset += getPosition();
+    if (dir == std::ios::end) offset += std::max(fileSize, getPosition());
+
+    return seekpos(pos_type(offset), which);
+}
+
+MappedWriteBuffer::pos_type MappedWriteBuffer::seekpos(pos_type position, std::ios::openmode which)
+{
+    if (!(which & std::ios::out) || position < 0 || hasError) return pos_type(off_type(-1));
+
+    // skipped ranges read back as zeros, like with any other sparse write
+    auto target = static_cast<uint64_t>(off_type(position));
+    fileSize    = std::max(fileSize, getPosition());
+    if (!reserve(target)) return pos_type(off_type(-1));
+
+    setp(data + target, data + capacity);
+    return position;
+}
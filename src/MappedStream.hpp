@@ -0,0 +1,78 @@
+#pragma once
+
+#include "OutputBuffer.hpp"
+
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+/*
+ * Read-only mapping of a whole file.
+ */
+class MappedFile
+{
+    const char* data = nullptr;
+    uint64_t size    = 0;
+
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const;
+    uint64_t getSize() const;
+};
+
+// maps every file only once while it is in use, e.g. by the readers of several tables inside it
+std::shared_ptr<MappedFile> openMappedFile(const std::string& path);
+
+/*
+ * Input stream buffer over a mapped file, keeping its mapping alive. Seeking is free.
+ */
+class MappedReadBuffer : public std::streambuf
+{
+    std::shared_ptr<MappedFile> file;
+
+protected:
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    MappedReadBuffer(std::shared_ptr<MappedFile> file);
+};
+
+/*
+ * Output stream buffer writing straight into a shared memory mapping of the file, so writes are plain copies without
+ * any syscalls. The file is preallocated to the size hint once and grown geometrically when the hint was too small.
+ * The file gets truncated to the written size when the buffer is finished.
+ */
+class MappedWriteBuffer : public std::streambuf, public OutputBuffer
+{
+    int fileFd        = -1;
+    char* data        = nullptr;
+    uint64_t capacity = 0;
+    uint64_t fileSize = 0; // largest position written to
+    bool hasError     = false;
+
+    uint64_t getPosition() const;
+    bool reserve(uint64_t size);
+    bool remap(uint64_t newSize);
+    void unmap();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* values, std::streamsize count) override;
+    int sync() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    MappedWriteBuffer(const std::string& path, uint64_t sizeHint);
+    ~MappedWriteBuffer();
+
+    bool finish() override;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <streambuf>
+
+/*
+ * Output stream buffers whose last writes only happen once they are finished, like the trailer of a compressed
+ * stream or the final size of a mapped file. Finishing reports whether all of it was written, destructors finish
+ * without reporting anything.
+ */
+class OutputBuffer
+{
+public:
+    virtual ~OutputBuffer() = default;
+
+    // writes everything still pending and releases the file, only the first call does any work
+    virtual bool finish() = 0;
+};
+
+// finishes any output stream buffer, false when anything couldn't be written
+bool finishOutputBuffer(std::streambuf& buffer);
@@ -0,0 +1,132 @@
+#include "ParallelUnpack.hpp"
+
+#include "CSVChannel.hpp"
+#include "ChannelFactory.hpp"
+#include "ReadWriter.hpp"
+#include "RowArena.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+constexpr std::size_t MIN_BLOCK_SIZE                = 1024;
+constexpr std::size_t BLOCKS_PER_THREAD             = 8;
+constexpr std::size_t MAX_PENDING_BLOCKS_PER_THREAD = 4;
+
+struct Block
+{
+    std::string data;
+    bool isDone = false;
+};
+
+void unpackParallel(const boost::json::object& input,
+                    std::ostream& output,
+                    const Structure& structure,
+                    const std::optional<Query>& query,
+                    const RecordIndex& index,
+                    std::size_t first,
+                    std::size_t last,
+                    std::size_t threadCount)
+{
+    auto entryCount = last - first;
+    auto blockSize  = std::max(MIN_BLOCK_SIZE, entryCount / (threadCount * BLOCKS_PER_THREAD) + 1);
+    auto blockCount = (entryCount + blockSize - 1) / blockSize;
+    auto maxPending = threadCount * MAX_PENDING_BLOCKS_PER_THREAD;
+
+    std::vector<Block> blocks(blockCount);
+    std::size_t nextBlock    = 0;
+    std::size_t writtenBlock = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable blockDone;
+    std::condition_variable blockWritten;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            std::shared_ptr<Reader> reader  = readerFactory(input, structure);
+            std::optional<Query> localQuery = query;
+            RowArena arena;
+
+            while (true)
+            {
+                std::size_t current;
+                {
+                    std::unique_lock lock(mutex);
+                    blockWritten.wait(lock, [&] { return error || nextBlock < writtenBlock + maxPending; });
+                    if (error || nextBlock >= blockCount) return;
+                    current = nextBlock++;
+                }
+
+                auto blockFirst = first + current * blockSize;
+                auto blockLast  = std::min(last, blockFirst + blockSize);
+                TraceSpan span("decode block", std::to_string(blockFirst));
+
+                std::ostringstream stream;
+                std::shared_ptr<Writer> writer = std::make_shared<CSVWriter>(stream);
+                reader->setPosition(index.getOffset(blockFirst));
+
+                for (auto i = blockFirst; i < blockLast; i++)
+                {
+                    if (localQuery)
+                        localQuery->convertEntry(*reader, *writer);
+                    else
+                        convertEntry(structure, *reader, *writer, arena.get());
+
+                    arena.reset();
+                }
+
+                {
+                    std::lock_guard lock(mutex);
+                    blocks[current].data   = std::move(stream).str();
+                    blocks[current].isDone = true;
+                }
+                blockDone.notify_one();
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            blockDone.notify_all();
+            blockWritten.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threadCount; i++)
+        threads.emplace_back(worker);
+
+    while (writtenBlock < blockCount)
+    {
+        std::string data;
+        {
+            std::unique_lock lock(mutex);
+            blockDone.wait(lock, [&] { return error || blocks[writtenBlock].isDone; });
+            if (error) break;
+            data = std::move(blocks[writtenBlock].data);
+        }
+
+        {
+            TraceSpan span("write block");
+            output << data;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            writtenBlock++;
+        }
+        blockWritten.notify_all();
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error) std::rethrow_exception(error);
+}
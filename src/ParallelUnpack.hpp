@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Query.hpp"
+#include "RecordIndex.hpp"
+#include "Structure.hpp"
+
+#include <optional>
+#include <ostream>
+
+/*
+ * Decodes the entries [first, last) of the input on multiple threads. The record index splits the input into blocks
+ * of entries, every worker decodes whole blocks with its own reader into in-memory CSV chunks, which get written to
+ * the output stream in order.
+ */
+void unpackParallel(const boost::json::object& input,
+                    std::ostream& output,
+                    const Structure& structure,
+                    const std::optional<Query>& query,
+                    const RecordIndex& index,
+                    std::size_t first,
+                    std::size_t last,
+                    std::size_t threadCount);
@@ -0,0 +1,74 @@
+#include "Pipeline.hpp"
+
+#include "AllocationStats.hpp"
+#include "SpscRing.hpp"
+#include "Table.hpp"
+#include "Trace.hpp"
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+constexpr std::size_t PIPELINE_BATCH_SIZE  = 4096;
+constexpr std::size_t PIPELINE_BATCH_COUNT = 4;
+
+void convertPipelined(const Structure& structure, Reader& reader, Writer& writer)
+{
+    SpscRing<std::unique_ptr<Table>> batches(PIPELINE_BATCH_COUNT);
+    std::exception_ptr error;
+
+    auto decode = [&]()
+    {
+        AllocationPhase phase("decode batches");
+        try
+        {
+            for (std::size_t first = 0;; first += PIPELINE_BATCH_SIZE)
+            {
+                auto batch = batches.beginPush();
+                if (!batch) break;
+
+                TraceSpan span("decode batch", std::to_string(first));
+                if (*batch)
+                    (*batch)->clear();
+                else
+                    *batch = std::make_unique<Table>(structure);
+
+                auto count = (*batch)->load(reader, PIPELINE_BATCH_SIZE);
+                if (count == 0) break;
+
+                batches.endPush();
+                if (count < PIPELINE_BATCH_SIZE) break;
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        batches.close();
+    };
+
+    std::thread decoder(decode);
+    AllocationPhase phase("encode batches");
+    try
+    {
+        while (auto batch = batches.beginPop())
+        {
+            {
+                TraceSpan span("encode batch");
+                (*batch)->storeRows(writer);
+            }
+            batches.endPop();
+        }
+    }
+    catch (...)
+    {
+        batches.close();
+        decoder.join();
+        throw;
+    }
+
+    decoder.join();
+    if (error) std::rethrow_exception(error);
+}
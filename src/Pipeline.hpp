@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+
+/*
+ * Converts all remaining entries of the reader in stages: a thread of its own decodes batches of entries into tables,
+ * which the calling thread encodes with the writer, connected by a small ring of reused batches. Channels opened with
+ * the "pipeline" key add a thread reading the input ahead and one writing the output behind, so a single file that
+ * can't be split into blocks of entries still keeps four cores busy with a bounded amount of memory.
+ */
+void convertPipelined(const Structure& structure, Reader& reader, Writer& writer);
@@ -0,0 +1,225 @@
+#include "PipelineStream.hpp"
+
+constexpr std::size_t PIPELINE_BLOCK_SIZE  = 1024 * 1024;
+constexpr std::size_t PIPELINE_BLOCK_COUNT = 4;
+
+/* Prefetching Buffer */
+PrefetchingBuffer::PrefetchingBuffer(std::unique_ptr<std::streambuf> fileBuffer)
+    : fileBuffer(std::move(fileBuffer))
+    , ring(PIPELINE_BLOCK_COUNT)
+{
+    setg(nullptr, nullptr, nullptr);
+}
+
+PrefetchingBuffer::~PrefetchingBuffer() { stop(); }
+
+void PrefetchingBuffer::prefetch()
+{
+    try
+    {
+        while (auto block = ring.beginPush())
+        {
+            block->resize(PIPELINE_BLOCK_SIZE);
+            auto count = fileBuffer->sgetn(block->data(), block->size());
+            if (count <= 0) break;
+
+            block->resize(count);
+            ring.endPush();
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    ring.close();
+}
+
+void PrefetchingBuffer::stop()
+{
+    if (!worker.joinable()) return;
+
+    ring.close();
+    worker.join();
+    ring.reset();
+    current = nullptr;
+    error   = nullptr;
+    setg(nullptr, nullptr, nullptr);
+}
+
+PrefetchingBuffer::int_type PrefetchingBuffer::underflow()
+{
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    // started on the first read, so the initial seek to the offset of the data doesn't read anything twice
+    if (!worker.joinable()) worker = std::thread(&PrefetchingBuffer::prefetch, this);
+
+    if (current)
+    {
+        position += current->size();
+        ring.endPop();
+    }
+
+    current = ring.beginPop();
+    if (!current)
+    {
+        setg(nullptr, nullptr, nullptr);
+        if (error) std::rethrow_exception(error);
+        return traits_type::eof();
+    }
+
+    setg(current->data(), current->data(), current->data() + current->size());
+    return traits_type::to_int_type(*gptr());
+}
+
+PrefetchingBuffer::pos_type
+PrefetchingBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::end) return pos_type(off_type(-1));
+    if (dir == std::ios::cur)
+    {
+        // telling the position doesn't restart the prefetching
+        if (offset == 0) return pos_type(off_type(position + (gptr() - eback())));
+        offset += position + (gptr() - eback());
+    }
+
+    return seekpos(pos_type(offset), which);
+}
+
+PrefetchingBuffer::pos_type PrefetchingBuffer::seekpos(pos_type target, std::ios::openmode which)
+{
+    if (!(which & std::ios::in)) return pos_type(off_type(-1));
+
+    auto offset = static_cast<uint64_t>(off_type(target));
+    if (current && offset >= position && offset < position + (egptr() - eback()))
+    {
+        setg(eback(), eback() + (offset - position), egptr());
+        return target;
+    }
+
+    stop();
+    if (fileBuffer->pubseekpos(target, std::ios::in) == pos_type(off_type(-1))) return pos_type(off_type(-1));
+
+    position = offset;
+    return target;
+}
+
+/* Write Behind Buffer */
+WriteBehindBuffer::WriteBehindBuffer(std::unique_ptr<std::streambuf> fileBuffer)
+    : fileBuffer(std::move(fileBuffer))
+    , ring(PIPELINE_BLOCK_COUNT)
+{
+    current = ring.beginPush();
+    current->resize(PIPELINE_BLOCK_SIZE);
+    setp(current->data(), current->data() + current->size());
+
+    worker = std::thread(&WriteBehindBuffer::write, this);
+}
+
+WriteBehindBuffer::~WriteBehindBuffer() { finish(); }
+
+bool WriteBehindBuffer::finish()
+{
+    if (!worker.joinable()) return !hasError;
+
+    if (!submitCurrent()) hasError = true;
+    ring.close();
+    worker.join();
+
+    if (!finishOutputBuffer(*fileBuffer)) hasError = true;
+    return !hasError;
+}
+
+void WriteBehindBuffer::write()
+{
+    while (auto block = ring.beginPop())
+    {
+        bool isWritten = false;
+        try
+        {
+            auto size = static_cast<std::streamsize>(block->size());
+            isWritten = fileBuffer->sputn(block->data(), size) == size;
+        }
+        catch (...)
+        {
+        }
+
+        // stops taking blocks, which fails every further write of the producer
+        if (!isWritten)
+        {
+            hasError = true;
+            ring.close();
+            return;
+        }
+
+        ring.endPop();
+    }
+}
+
+bool WriteBehindBuffer::submitCurrent()
+{
+    auto count = pptr() - pbase();
+    if (count == 0) return !hasError;
+
+    current->resize(count);
+    position += count;
+    ring.endPush();
+
+    current = ring.beginPush();
+    if (!current)
+    {
+        setp(nullptr, nullptr);
+        return false;
+    }
+
+    current->resize(PIPELINE_BLOCK_SIZE);
+    setp(current->data(), current->data() + current->size());
+    return !hasError;
+}
+
+WriteBehindBuffer::int_type WriteBehindBuffer::overflow(int_type ch)
+{
+    if (!submitCurrent()) return traits_type::eof();
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+int WriteBehindBuffer::sync()
+{
+    if (!submitCurrent()) return -1;
+
+    ring.waitUntilEmpty();
+    if (hasError) return -1;
+
+    return fileBuffer->pubsync();
+}
+
+WriteBehindBuffer::pos_type
+WriteBehindBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::end) return pos_type(off_type(-1));
+    if (dir == std::ios::cur)
+    {
+        // telling the position doesn't need to wait for the writes
+        if (offset == 0) return pos_type(off_type(position + (pptr() - pbase())));
+        offset += position + (pptr() - pbase());
+    }
+
+    return seekpos(pos_type(offset), which);
+}
+
+WriteBehindBuffer::pos_type WriteBehindBuffer::seekpos(pos_type target, std::ios::openmode which)
+{
+    if (!(which & std::ios::out)) return pos_type(off_type(-1));
+    if (!submitCurrent()) return pos_type(off_type(-1));
+
+    ring.waitUntilEmpty();
+    if (hasError || fileBuffer->pubseekpos(target, std::ios::out) == pos_type(off_type(-1)))
+        return pos_type(off_type(-1));
+
+    position = static_cast<uint64_t>(off_type(target));
+    return target;
+}
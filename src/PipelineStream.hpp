@@ -0,0 +1,66 @@
+#pragma once
+
+#include "OutputBuffer.hpp"
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+/*
+ * Reads blocks ahead of the consumer on a thread of its own, handed over through a ring of reused blocks. Seeks
+ * within the current block are free, all others restart the thread at the new position.
+ */
+class PrefetchingBuffer : public std::streambuf
+{
+    std::unique_ptr<std::streambuf> fileBuffer;
+    SpscRing<std::vector<char>> ring;
+    std::thread worker;
+    std::vector<char>* current = nullptr;
+    uint64_t position          = 0; // offset of the current block
+    std::exception_ptr error;
+
+    void prefetch();
+    void stop();
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    PrefetchingBuffer(std::unique_ptr<std::streambuf> fileBuffer);
+    ~PrefetchingBuffer();
+};
+
+/*
+ * Fills blocks of a ring in place, which a thread of its own writes to the file. Syncing and seeking wait until every
+ * submitted block has been written.
+ */
+class WriteBehindBuffer : public std::streambuf, public OutputBuffer
+{
+    std::unique_ptr<std::streambuf> fileBuffer;
+    SpscRing<std::vector<char>> ring;
+    std::thread worker;
+    std::vector<char>* current = nullptr;
+    uint64_t position          = 0; // offset of the current block
+    std::atomic<bool> hasError = false;
+
+    void write();
+    bool submitCurrent();
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    WriteBehindBuffer(std::unique_ptr<std::streambuf> fileBuffer);
+    ~WriteBehindBuffer();
+
+    bool finish() override;
+};
@@ -0,0 +1,302 @@
+#include "Profile.hpp"
+
+#include "Hash.hpp"
+#include "Table.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+constexpr std::size_t HYPERLOGLOG_REGISTERS = std::size_t(1) << HYPERLOGLOG_PRECISION;
+constexpr int32_t MAX_FLOAT_EXPONENT        = 64; // binary exponents of floats beyond ±64 share the outermost bucket
+
+namespace
+{
+    // splitmix64 finalizer, so similar values still end up in unrelated registers
+    uint64_t mixHash(uint64_t hash)
+    {
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    class HyperLogLog
+    {
+        std::array<uint8_t, HYPERLOGLOG_REGISTERS> registers{};
+
+    public:
+        void add(uint64_t value)
+        {
+            auto hash  = mixHash(value);
+            auto index = hash >> (64 - HYPERLOGLOG_PRECISION);
+            // leading zeros of the remaining bits, the guard bit limits them to the bits there are
+            auto rest  = (hash << HYPERLOGLOG_PRECISION) | (uint64_t(1) << (HYPERLOGLOG_PRECISION - 1));
+            auto rank  = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+            registers[index] = std::max(registers[index], rank);
+        }
+
+        uint64_t estimate() const
+        {
+            double sum     = 0;
+            uint64_t empty = 0;
+            for (auto rank : registers)
+            {
+                sum += std::ldexp(1.0, -rank);
+                empty += rank == 0;
+            }
+
+            double count    = HYPERLOGLOG_REGISTERS;
+            double estimate = 0.7213 / (1 + 1.079 / count) * count * count / sum;
+            // linear counting is more accurate while many registers are still empty
+            if (estimate <= 2.5 * count && empty != 0) estimate = count * std::log(count / empty);
+            return std::llround(estimate);
+        }
+    };
+
+    struct FieldProfile
+    {
+        uint64_t zeros       = 0; // numbers equal to 0, empty strings and arrays
+        uint64_t nans        = 0;
+        uint64_t integral    = 0; // floats without a fraction
+        double min           = std::numeric_limits<double>::infinity(); // of numbers and array elements
+        double max           = -std::numeric_limits<double>::infinity();
+        uint64_t minLength   = std::numeric_limits<uint64_t>::max();
+        uint64_t maxLength   = 0;
+        uint64_t totalLength = 0;
+        // integers and lengths by the bit width of their magnitude, floats by their binary exponent
+        std::array<uint64_t, 2 * MAX_FLOAT_EXPONENT + 1> histogram{};
+        HyperLogLog distinct;
+    };
+
+    // min, max and zeros of a batch in branchless loops, which the compiler vectorizes
+    template<typename T> uint64_t reduceNumbers(FieldProfile& profile, std::span<const T> values)
+    {
+        T low  = std::numeric_limits<T>::max();
+        T high = std::numeric_limits<T>::lowest();
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            // NaNs fail every comparison and never replace these
+            low  = std::numeric_limits<T>::infinity();
+            high = -std::numeric_limits<T>::infinity();
+        }
+
+        uint64_t zeros = 0;
+        for (auto value : values)
+        {
+            low  = value < low ? value : low;
+            high = value > high ? value : high;
+            zeros += value == T(0);
+        }
+
+        if (!values.empty())
+        {
+            profile.min = std::min(profile.min, static_cast<double>(low));
+            profile.max = std::max(profile.max, static_cast<double>(high));
+        }
+        return zeros;
+    }
+
+    template<typename T> void addColumn(FieldProfile& profile, std::span<const T> values)
+    {
+        profile.zeros += reduceNumbers(profile, values);
+
+        for (auto value : values)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (std::isnan(value))
+                {
+                    profile.nans++;
+                    continue;
+                }
+
+                profile.integral += std::isfinite(value) && std::trunc(value) == value;
+                if (value != 0)
+                {
+                    auto exponent = std::clamp<int32_t>(std::ilogb(value), -MAX_FLOAT_EXPONENT, MAX_FLOAT_EXPONENT);
+                    profile.histogram[exponent + MAX_FLOAT_EXPONENT]++;
+                }
+                // adding 0 turns -0 into 0, so both count as one value
+                profile.distinct.add(std::bit_cast<uint64_t>(static_cast<double>(value) + 0.0));
+            }
+            else
+            {
+                auto magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+                profile.histogram[std::bit_width(magnitude)]++;
+                profile.distinct.add(static_cast<uint64_t>(value));
+            }
+        }
+    }
+
+    void addLength(FieldProfile& profile, uint64_t length)
+    {
+        profile.zeros += length == 0;
+        profile.minLength = std::min(profile.minLength, length);
+        profile.maxLength = std::max(profile.maxLength, length);
+        profile.totalLength += length;
+        profile.histogram[std::bit_width(length)]++;
+    }
+
+    void addColumn(FieldProfile& profile, std::span<const std::string_view> values)
+    {
+        for (auto value : values)
+        {
+            addLength(profile, value.size());
+            profile.distinct.add(fnv1a(value.data(), value.size()));
+        }
+    }
+
+    template<typename T> void addColumn(FieldProfile& profile, std::span<const std::span<const T>> values)
+    {
+        for (auto value : values)
+        {
+            addLength(profile, value.size());
+            reduceNumbers(profile, value);
+            profile.distinct.add(fnv1a(value.data(), value.size_bytes()));
+        }
+    }
+
+    bool isHex(FieldType type)
+    {
+        return type == FieldType::HEX8 || type == FieldType::HEX16 || type == FieldType::HEX32;
+    }
+
+    // the narrowest integer type holding every value, keeping the signedness of the field when both would fit
+    std::string getSmallestType(const FieldProfile& profile, bool isSigned)
+    {
+        for (int32_t bits : { 8, 16, 24, 32 })
+        {
+            auto range        = std::ldexp(1.0, bits);
+            bool fitsSigned   = profile.min >= -range / 2 && profile.max < range / 2;
+            bool fitsUnsigned = profile.min >= 0 && profile.max < range;
+            if (fitsSigned && (isSigned || !fitsUnsigned)) return "int" + std::to_string(bits);
+            if (fitsUnsigned) return "uint" + std::to_string(bits);
+        }
+
+        return isSigned ? "int32" : "uint32";
+    }
+
+    boost::json::value toNumber(double value, bool isInteger)
+    {
+        if (std::isinf(value)) return nullptr;
+        if (isInteger) return static_cast<int64_t>(value);
+        return value;
+    }
+
+    boost::json::array getHistogram(const FieldProfile& profile, bool isFloat)
+    {
+        boost::json::array histogram;
+        for (std::size_t i = 0; i < profile.histogram.size(); i++)
+        {
+            if (profile.histogram[i] == 0) continue;
+
+            // magnitudes in [from, to]
+            boost::json::object bucket;
+            if (isFloat)
+            {
+                auto exponent  = static_cast<int32_t>(i) - MAX_FLOAT_EXPONENT;
+                bucket["from"] = std::ldexp(1.0, exponent);
+                bucket["to"]   = std::ldexp(1.0, exponent + 1);
+            }
+            else
+            {
+                bucket["from"] = i == 0 ? 0 : uint64_t(1) << (i - 1);
+                bucket["to"]   = i == 0 ? 0 : (i == 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << i) - 1);
+            }
+            bucket["count"] = profile.histogram[i];
+            histogram.push_back(std::move(bucket));
+        }
+
+        return histogram;
+    }
+
+    template<typename T>
+    boost::json::object
+    toJson(const FieldProfile& profile, const Field& field, const std::vector<T>&, uint64_t entryCount)
+    {
+        boost::json::object object;
+        object["type"] = field.typeName;
+
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            constexpr bool isFloat = std::is_floating_point_v<T>;
+            object["min"]          = toNumber(profile.min, !isFloat);
+            object["max"]          = toNumber(profile.max, !isFloat);
+            object["zeros"]        = profile.zeros;
+            if constexpr (isFloat)
+            {
+                object["nans"]     = profile.nans;
+                object["integral"] = profile.integral;
+            }
+            else if (!isHex(field.type) && entryCount != 0)
+                object["smallestType"] = getSmallestType(profile, std::is_signed_v<T>);
+            object["distinct"]  = profile.distinct.estimate();
+            object["histogram"] = getHistogram(profile, isFloat);
+        }
+        else
+        {
+            object["empty"]      = profile.zeros;
+            object["distinct"]   = profile.distinct.estimate();
+            object["minLength"]  = entryCount == 0 ? 0 : profile.minLength;
+            object["maxLength"]  = profile.maxLength;
+            object["meanLength"] = entryCount == 0 ? 0.0 : static_cast<double>(profile.totalLength) / entryCount;
+            if constexpr (!std::is_same_v<T, std::string_view>)
+            {
+                constexpr bool isFloat = std::is_floating_point_v<typename T::element_type>;
+                object["minElement"]   = toNumber(profile.min, !isFloat);
+                object["maxElement"]   = toNumber(profile.max, !isFloat);
+            }
+            object["histogram"] = getHistogram(profile, false);
+        }
+
+        return object;
+    }
+} // namespace
+
+boost::json::object profileColumns(Reader& reader, const Structure& structure)
+{
+    auto& fields = structure.getFields();
+    std::vector<FieldProfile> profiles(fields.size());
+    uint64_t entryCount = 0;
+
+    // decoded a batch at a time, the statistics get reduced a column at a time
+    Table batch(structure);
+    while (auto loaded = batch.load(reader, PROFILE_BATCH_SIZE))
+    {
+        TraceSpan span("profile batch");
+        for (std::size_t i = 0; i < fields.size(); i++)
+        {
+            std::visit(
+                [&](auto& values)
+                {
+                    using T = typename std::decay_t<decltype(values)>::value_type;
+                    addColumn(profiles[i], std::span<const T>(values));
+                },
+                batch.getColumn(i));
+        }
+
+        entryCount += loaded;
+        batch.clear();
+    }
+
+    boost::json::object fieldProfiles;
+    for (std::size_t i = 0; i < fields.size(); i++)
+        fieldProfiles[fields[i].name] = std::visit([&](auto& values)
+                                                   { return toJson(profiles[i], fields[i], values, entryCount); },
+                                                   batch.getColumn(i));
+
+    boost::json::object profile;
+    profile["entries"] = entryCount;
+    profile["fields"]  = std::move(fieldProfiles);
+    return profile;
+}
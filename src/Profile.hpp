@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+
+#include <boost/json.hpp>
+
+#include <cstddef>
+
+// entries loaded into a table at once, the statistics are reduced a whole column of the batch at a time
+constexpr std::size_t PROFILE_BATCH_SIZE = 4096;
+// 2^12 registers, about 1.6% standard error for the distinct counts
+constexpr int32_t HYPERLOGLOG_PRECISION = 12;
+
+/*
+ * Streams the remaining entries of the reader once and returns statistics of every field, keyed by name:
+ * - numbers: min, max, zeros, distinct and a histogram of their magnitudes in powers of two. Integers also get the
+ *   smallest type holding all their values, floats the count of NaNs and of whole numbers.
+ * - strings and arrays: empty, distinct, min/max/mean length and a histogram of their lengths in powers of two.
+ *   Arrays also get the min and max of their elements.
+ * Distinct counts are HyperLogLog estimates.
+ */
+boost::json::object profileColumns(Reader& reader, const Structure& structure);
@@ -0,0 +1,255 @@
+#include "Query.hpp"
+
+#include "AllocationStats.hpp"
+#include "ReadWriter.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <functional>
+#include <stdexcept>
+#include <regex>
+
+std::size_t findField(const Structure& structure, const std::string& name)
+{
+    auto& fields = structure.getFields();
+    auto it      = std::find_if(fields.begin(), fields.end(), [&](const Field& field) { return field.name == name; });
+    if (it == fields.end()) throw std::runtime_error("Unknown field: " + name);
+
+    return std::distance(fields.begin(), it);
+}
+
+bool isNumeric(FieldType type)
+{
+    switch (type)
+    {
+        case FieldType::STRING:
+        case FieldType::INT24ARRAY:
+        case FieldType::INT32ARRAY:
+        case FieldType::UINT24ARRAY:
+        case FieldType::UINT32ARRAY:
+        case FieldType::FLOATARRAY:
+        case FieldType::DOUBLEARRAY: return false;
+        default: return true;
+    }
+}
+
+std::vector<std::string> splitString(const std::string& string, const std::string& delimiter)
+{
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    for (auto end = string.find(delimiter); end != std::string::npos; end = string.find(delimiter, start))
+    {
+        parts.push_back(string.substr(start, end - start));
+        start = end + delimiter.size();
+    }
+    parts.push_back(string.substr(start));
+
+    return parts;
+}
+
+Comparison toComparison(const std::string& op)
+{
+    if (op == "==" || op == "=") return Comparison::EQUAL;
+    if (op == "!=") return Comparison::NOT_EQUAL;
+    if (op == "<") return Comparison::LESS;
+    if (op == "<=") return Comparison::LESS_EQUAL;
+    if (op == ">") return Comparison::GREATER;
+
+    return Comparison::GREATER_EQUAL;
+}
+
+double parseConditionValue(const std::string& value)
+{
+    try
+    {
+        std::size_t length = 0;
+        auto number        = std::stod(value, &length);
+        if (length == value.size()) return number;
+    }
+    catch (std::logic_error&)
+    {
+    }
+
+    throw std::runtime_error("Invalid condition value: " + value);
+}
+
+/* Predicate */
+Predicate::Predicate(const std::string& expression, const Structure& structure)
+{
+    static const std::regex conditionRegex(R"(^\s*(\w+)\s*(==|!=|<=|>=|=|<|>)\s*([-+.\w]+)\s*$)");
+
+    for (auto& clauseString : splitString(expression, "||"))
+    {
+        auto& clause = clauses.emplace_back();
+        for (auto& conditionString : splitString(clauseString, "&&"))
+        {
+            std::smatch match;
+            if (!std::regex_match(conditionString, match, conditionRegex))
+                throw std::runtime_error("Invalid condition: " + conditionString);
+
+            auto field = findField(structure, match[1]);
+            if (!isNumeric(structure.getFields()[field].type))
+                throw std::runtime_error("Conditions are only supported on numeric fields: " + match[1].str());
+
+            clause.push_back({ field, toComparison(match[2]), parseConditionValue(match[3]) });
+        }
+    }
+}
+
+std::vector<std::size_t> Predicate::getFields() const
+{
+    std::vector<std::size_t> fields;
+    for (auto& clause : clauses)
+        for (auto& condition : clause)
+            fields.push_back(condition.field);
+
+    return fields;
+}
+
+bool Predicate::evaluate(const std::vector<Value>& row) const
+{
+    auto matches = [&](const Condition& condition)
+    {
+        auto value = toNumber(row[condition.field]);
+        switch (condition.comparison)
+        {
+            case Comparison::EQUAL: return value == condition.value;
+            case Comparison::NOT_EQUAL: return value != condition.value;
+            case Comparison::LESS: return value < condition.value;
+            case Comparison::LESS_EQUAL: return value <= condition.value;
+            case Comparison::GREATER: return value > condition.value;
+            case Comparison::GREATER_EQUAL: return value >= condition.value;
+        }
+        return false;
+    };
+
+    return std::any_of(clauses.begin(),
+                       clauses.end(),
+                       [&](auto& clause) { return std::all_of(clause.begin(), clause.end(), matches); });
+}
+
+namespace
+{
+    template<typename T, typename Compare>
+    void compareColumn(const std::vector<T>& values, double value, std::vector<uint8_t>& matches, Compare compare)
+    {
+        for (std::size_t i = 0; i < values.size(); i++)
+            matches[i] &= compare(static_cast<double>(values[i]), value);
+    }
+} // namespace
+
+std::vector<uint8_t> Predicate::evaluate(const Table& table) const
+{
+    std::vector<uint8_t> matches(table.getRowCount(), 0);
+    std::vector<uint8_t> clauseMatches;
+
+    for (auto& clause : clauses)
+    {
+        clauseMatches.assign(table.getRowCount(), 1);
+        for (auto& condition : clause)
+        {
+            auto compare = [&](auto& values)
+            {
+                using T = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_arithmetic_v<T>)
+                {
+                    // one loop per comparison, so the compiler can vectorize them
+                    switch (condition.comparison)
+                    {
+                        case Comparison::EQUAL:
+                            compareColumn(values, condition.value, clauseMatches, std::equal_to<double>());
+                            break;
+                        case Comparison::NOT_EQUAL:
+                            compareColumn(values, condition.value, clauseMatches, std::not_equal_to<double>());
+                            break;
+                        case Comparison::LESS:
+                            compareColumn(values, condition.value, clauseMatches, std::less<double>());
+                            break;
+                        case Comparison::LESS_EQUAL:
+                            compareColumn(values, condition.value, clauseMatches, std::less_equal<double>());
+                            break;
+                        case Comparison::GREATER:
+                            compareColumn(values, condition.value, clauseMatches, std::greater<double>());
+                            break;
+                        case Comparison::GREATER_EQUAL:
+                            compareColumn(values, condition.value, clauseMatches, std::greater_equal<double>());
+                            break;
+                    }
+                }
+            };
+            std::visit(compare, table.getColumn(condition.field));
+        }
+
+        for (std::size_t i = 0; i < matches.size(); i++)
+            matches[i] |= clauseMatches[i];
+    }
+
+    return matches;
+}
+
+/* Query */
+Query::Query(const Structure& structure, const std::string& columnList, const std::string& where)
+    : structure(structure)
+    , isRead(structure.getFieldCount(), false)
+    , row(structure.getFieldCount())
+{
+    if (columnList.empty())
+    {
+        for (std::size_t i = 0; i < structure.getFieldCount(); i++)
+            columns.push_back(i);
+    }
+    else
+    {
+        std::vector<std::string> names;
+        boost::algorithm::split(names, columnList, boost::is_any_of(","));
+        for (auto& name : names)
+        {
+            // the structure of the output is keyed by name, so every column can only appear once
+            auto column = findField(structure, boost::algorithm::trim_copy(name));
+            if (std::find(columns.begin(), columns.end(), column) != columns.end())
+                throw std::runtime_error("Duplicate column: " + boost::algorithm::trim_copy(name));
+
+            columns.push_back(column);
+        }
+    }
+
+    if (!where.empty()) predicate.emplace(where, structure);
+
+    for (auto column : columns)
+        isRead[column] = true;
+    if (predicate)
+        for (auto field : predicate->getFields())
+            isRead[field] = true;
+}
+
+boost::json::object Query::getStructure() const
+{
+    boost::json::object projected;
+    for (auto column : columns)
+        projected[structure.getFields()[column].name] = structure.getFields()[column].typeName;
+
+    return projected;
+}
+
+void Query::convertEntry(Reader& inReader, Writer& outWriter)
+{
+    auto& fields = structure.getFields();
+    for (std::size_t i = 0; i < fields.size(); i++)
+    {
+        AllocationField scope(fields[i].type);
+        if (isRead[i])
+            getReadWriter(fields[i].type).read(inReader, row[i]);
+        else
+            inReader.skip(fields[i].type);
+    }
+
+    if (predicate && !predicate->evaluate(row)) return;
+
+    outWriter.startEntry();
+    for (auto column : columns)
+    {
+        AllocationField scope(fields[column].type);
+        getReadWriter(fields[column].type).write(fields[column].name, row[column], outWriter);
+    }
+    outWriter.finishEntry();
+}
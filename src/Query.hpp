@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+#include "Table.hpp"
+#include "Value.hpp"
+
+#include <optional>
+
+// throws for unknown fields
+std::size_t findField(const Structure& structure, const std::string& name);
+bool isNumeric(FieldType type);
+
+enum class Comparison
+{
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+};
+
+/*
+ * A condition on numeric fields in the form of "hpMax >= 100 && groupId == 3 || id < 10".
+ * && binds stronger than ||, parentheses are not supported.
+ */
+class Predicate
+{
+    struct Condition
+    {
+        std::size_t field;
+        Comparison comparison;
+        double value;
+    };
+
+    std::vector<std::vector<Condition>> clauses{}; // any clause must match, with all its conditions
+
+public:
+    Predicate(const std::string& expression, const Structure& structure);
+
+    std::vector<std::size_t> getFields() const;
+    bool evaluate(const std::vector<Value>& row) const;
+    // one flag per entry of the table, evaluated a whole column at a time
+    std::vector<uint8_t> evaluate(const Table& table) const;
+};
+
+/*
+ * Projects and filters entries while converting. Only the fields needed for the output or the predicate get decoded,
+ * everything else is skipped by the reader and rows are filtered before they reach the writer.
+ */
+class Query
+{
+    const Structure& structure;
+    std::vector<std::size_t> columns{};
+    std::vector<bool> isRead{};
+    std::optional<Predicate> predicate{};
+    std::vector<Value> row{};
+
+public:
+    Query(const Structure& structure, const std::string& columnList, const std::string& where);
+
+    boost::json::object getStructure() const;
+    void convertEntry(Reader& inReader, Writer& outWriter);
+};
@@ -0,0 +1,66 @@
+#include "ReadWriter.hpp"
+
+#include "AllocationStats.hpp"
+
+#include <map>
+
+using ReadWriterMap = std::map<FieldType, std::shared_ptr<ReadWriter>>;
+
+ReadWriterMap registerReadWriter()
+{
+    ReadWriterMap map;
+    map[FieldType::INT8]  = std::make_shared<ReadWriteTuple<int8_t>>(&Reader::readInt8, &Writer::writeInt8);
+    map[FieldType::INT16] = std::make_shared<ReadWriteTuple<int16_t>>(&Reader::readInt16, &Writer::writeInt16);
+    map[FieldType::INT24] = std::make_shared<ReadWriteTuple<int32_t>>(&Reader::readInt24, &Writer::writeInt24);
+    map[FieldType::INT32] = std::make_shared<ReadWriteTuple<int32_t>>(&Reader::readInt32, &Writer::writeInt32);
+
+    map[FieldType::UINT8]  = std::make_shared<ReadWriteTuple<uint8_t>>(&Reader::readUInt8, &Writer::writeUInt8);
+    map[FieldType::UINT16] = std::make_shared<ReadWriteTuple<uint16_t>>(&Reader::readUInt16, &Writer::writeUInt16);
+    map[FieldType::UINT24] = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readUInt24, &Writer::writeUInt24);
+    map[FieldType::UINT32] = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readUInt32, &Writer::writeUInt32);
+
+    map[FieldType::HEX8]  = std::make_shared<ReadWriteTuple<uint8_t>>(&Reader::readHex8, &Writer::writeHex8);
+    map[FieldType::HEX16]  = std::make_shared<ReadWriteTuple<uint16_t>>(&Reader::readHex16, &Writer::writeHex16);
+    map[FieldType::HEX32]  = std::make_shared<ReadWriteTuple<uint32_t>>(&Reader::readHex32, &Writer::writeHex32);
+
+    map[FieldType::FLOAT]  = std::make_shared<ReadWriteTuple<float>>(&Reader::readFloat, &Writer::writeFloat);
+    map[FieldType::DOUBLE] = std::make_shared<ReadWriteTuple<double>>(&Reader::readDouble, &Writer::writeDouble);
+    map[FieldType::STRING] =
+        std::make_shared<ReadWriteTuple<std::pmr::string>>(&Reader::readString, &Writer::writeString);
+
+    map[FieldType::INT24ARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<int32_t>>>(&Reader::readInt24Array, &Writer::writeInt24Array);
+    map[FieldType::INT32ARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<int32_t>>>(&Reader::readInt32Array, &Writer::writeInt32Array);
+    map[FieldType::UINT24ARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<uint32_t>>>(&Reader::readUInt24Array,
+                                                                     &Writer::writeUInt24Array);
+    map[FieldType::UINT32ARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<uint32_t>>>(&Reader::readUInt32Array,
+                                                                     &Writer::writeUInt32Array);
+
+    map[FieldType::FLOATARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<float>>>(&Reader::readFloatArray, &Writer::writeFloatArray);
+    map[FieldType::DOUBLEARRAY] =
+        std::make_shared<ReadWriteTuple<std::pmr::vector<double>>>(&Reader::readDoubleArray, &Writer::writeDoubleArray);
+    return map;
+}
+
+ReadWriter& getReadWriter(FieldType type)
+{
+    static ReadWriterMap readWriter = registerReadWriter();
+    return *readWriter.at(type);
+}
+
+void convertEntry(const Structure& structure, Reader& inReader, Writer& outWriter, std::pmr::memory_resource* memory)
+{
+    outWriter.startEntry();
+
+    for (auto& field : structure.getFields())
+    {
+        AllocationField scope(field.type);
+        getReadWriter(field.type).convert(field.name, inReader, outWriter, memory);
+    }
+
+    outWriter.finishEntry();
+}
@@ -1,17 +1,58 @@
 #pragma once
 
 #include "Channel.hpp"
+#include "Structure.hpp"
+#include "Value.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <type_traits>
 
 class ReadWriter
 {
 public:
-    virtual void convert(std::string name, std::shared_ptr<Reader> inChannel, std::shared_ptr<Writer> outChannel) = 0;
+    virtual ~ReadWriter() = default;
+
+    virtual void
+    convert(std::string_view name, Reader& inChannel, Writer& outChannel, std::pmr::memory_resource* memory) = 0;
+    virtual void read(Reader& inChannel, Value& value)                               = 0;
+    virtual void write(std::string_view name, const Value& value, Writer& outChannel) = 0;
+
+    // strings and arrays get copied into the given memory resource, which has to outlive the column
+    virtual Column makeColumn()                                                                         = 0;
+    virtual void append(Reader& inChannel, Column& column, std::pmr::memory_resource* memory)          = 0;
+    virtual void write(std::string_view name, const Column& column, std::size_t row, Writer& outChannel) = 0;
+};
+
+/*
+ * Numbers are returned by value. Strings and arrays are read into a buffer owned by the caller and handed to the
+ * writer as a view of that buffer.
+ */
+template<typename T> struct FieldAccess
+{
+    using ReadFunction = T (Reader::*)();
+    using View         = T;
+};
+
+template<> struct FieldAccess<std::pmr::string>
+{
+    using ReadFunction = void (Reader::*)(std::pmr::string&);
+    using View         = std::string_view;
+};
+
+template<typename E> struct FieldAccess<std::pmr::vector<E>>
+{
+    using ReadFunction = void (Reader::*)(std::pmr::vector<E>&);
+    using View         = std::span<const E>;
 };
 
 template<typename T> class ReadWriteTuple : public ReadWriter
 {
-    using ReadFunction  = T (Reader::*)();
-    using WriteFunction = void (Writer::*)(std::string, T);
+    using ReadFunction  = typename FieldAccess<T>::ReadFunction;
+    using WriteFunction = void (Writer::*)(std::string_view, typename FieldAccess<T>::View);
 
     ReadFunction reader;
     WriteFunction writer;
@@ -23,13 +64,89 @@ public:
     {
     }
 
-    virtual void
-    convert(std::string name, std::shared_ptr<Reader> inChannel, std::shared_ptr<Writer> outChannel) override;
+    virtual void convert(std::string_view name,
+                         Reader& inChannel,
+                         Writer& outChannel,
+                         std::pmr::memory_resource* memory) override;
+    virtual void read(Reader& inChannel, Value& value) override;
+    virtual void write(std::string_view name, const Value& value, Writer& outChannel) override;
+
+    virtual Column makeColumn() override;
+    virtual void append(Reader& inChannel, Column& column, std::pmr::memory_resource* memory) override;
+    virtual void write(std::string_view name, const Column& column, std::size_t row, Writer& outChannel) override;
 };
 
 template<typename T>
-void ReadWriteTuple<T>::convert(std::string name, std::shared_ptr<Reader> inChannel, std::shared_ptr<Writer> outChannel)
+void ReadWriteTuple<T>::convert(std::string_view name,
+                                Reader& inChannel,
+                                Writer& outChannel,
+                                std::pmr::memory_resource* memory)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+        (outChannel.*writer)(name, (inChannel.*reader)());
+    else
+    {
+        T value(memory);
+        (inChannel.*reader)(value);
+        (outChannel.*writer)(name, value);
+    }
+}
+
+template<typename T> void ReadWriteTuple<T>::read(Reader& inChannel, Value& value)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+        value = (inChannel.*reader)();
+    else
+    {
+        // keeps the buffer of the previous entry, so its capacity gets reused
+        if (!std::holds_alternative<T>(value)) value.template emplace<T>();
+        (inChannel.*reader)(std::get<T>(value));
+    }
+}
+
+template<typename T> void ReadWriteTuple<T>::write(std::string_view name, const Value& value, Writer& outChannel)
+{
+    (outChannel.*writer)(name, std::get<T>(value));
+}
+
+template<typename T> Column ReadWriteTuple<T>::makeColumn()
+{
+    return std::vector<typename FieldAccess<T>::View>{};
+}
+
+template<typename T>
+void ReadWriteTuple<T>::append(Reader& inChannel, Column& column, std::pmr::memory_resource* memory)
 {
-    T val = ((*inChannel).*reader)();
-    ((*outChannel).*writer)(name, val);
+    using View  = typename FieldAccess<T>::View;
+    auto& views = std::get<std::vector<View>>(column);
+
+    if constexpr (std::is_arithmetic_v<T>)
+        views.push_back((inChannel.*reader)());
+    else
+    {
+        // read into a reused buffer first, so the memory of the column only grows by the final size
+        thread_local T buffer;
+        (inChannel.*reader)(buffer);
+
+        using Element = typename T::value_type;
+        auto data     = static_cast<Element*>(memory->allocate(buffer.size() * sizeof(Element), alignof(Element)));
+        std::copy(buffer.begin(), buffer.end(), data);
+        views.push_back(View(data, buffer.size()));
+    }
+}
+
+template<typename T>
+void ReadWriteTuple<T>::write(std::string_view name, const Column& column, std::size_t row, Writer& outChannel)
+{
+    (outChannel.*writer)(name, std::get<std::vector<typename FieldAccess<T>::View>>(column)[row]);
 }
+
+ReadWriter& getReadWriter(FieldType type);
+
+/*
+ * Strings and arrays of the entry are allocated from the given memory resource, which can be released afterwards.
+ */
+void convertEntry(const Structure& structure,
+                  Reader& inReader,
+                  Writer& outWriter,
+                  std::pmr::memory_resource* memory = std::pmr::get_default_resource());
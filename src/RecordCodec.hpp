@@ -0,0 +1,135 @@
+#pragma once
+
+#include "ByteOrder.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Encoding primitives shared by the binary channel and the record types generated by bdc-codegen. Only depends on
+ * ByteOrder.hpp and the standard library, so generated headers can be used without the rest of the converter.
+ */
+
+enum class RecordEncoding
+{
+    VALUE,                // stored like in memory, apart from the byte order
+    INT24,                // two's complement
+    INT24_SIGN_MAGNITUDE, // sign bit and 23 bit magnitude
+    UINT24,
+    DECIMAL24,            // sign bit, 3 bit decimal shift and 20 bit mantissa
+};
+
+struct RecordField
+{
+    const char* name;
+    std::size_t offset;        // of the member
+    std::size_t encodedOffset; // in the encoded record
+    std::size_t encodedSize;
+    RecordEncoding encoding;
+    ByteOrder byteOrder;
+};
+
+inline float decodeDecimal24(uint32_t raw)
+{
+    bool isNegative = raw & 0x800000;
+    int32_t shift   = (raw & 0x7FFFFF) >> 20;
+    float value     = static_cast<float>(raw & 0x0FFFFF);
+
+    for (auto i = 0; i < shift; i++)
+        value /= 10.0f;
+
+    if (isNegative) value *= -1.0f;
+
+    return value;
+}
+
+inline uint32_t encodeDecimal24(float value)
+{
+    constexpr float epsilon = 0.005f;
+    float tmpValue          = std::abs(value);
+    uint32_t shift          = 0u;
+
+    for (; shift < 8u; shift++)
+    {
+        if (std::abs(tmpValue - std::round(tmpValue)) < epsilon) break;
+        tmpValue *= 10.0f;
+    }
+
+    int32_t intValue    = static_cast<int32_t>(std::round(tmpValue));
+    uint32_t finalValue = intValue & 0x0FFFFF;
+    finalValue          = finalValue | (shift << 20);
+    if (value < 0) finalValue = finalValue | 0x800000;
+
+    return finalValue & 0xFFFFFF;
+}
+
+template<ByteOrder order, RecordEncoding encoding, typename T> T loadField(const char* bytes)
+{
+    if constexpr (encoding == RecordEncoding::INT24)
+        return static_cast<int32_t>(loadUInt24<order>(bytes) << 8) >> 8;
+    else if constexpr (encoding == RecordEncoding::INT24_SIGN_MAGNITUDE)
+    {
+        uint32_t raw      = loadUInt24<order>(bytes);
+        int32_t magnitude = raw & 0x7FFFFF;
+        return (raw & 0x800000) ? -magnitude : magnitude;
+    }
+    else if constexpr (encoding == RecordEncoding::UINT24)
+        return loadUInt24<order>(bytes);
+    else if constexpr (encoding == RecordEncoding::DECIMAL24)
+        return static_cast<T>(decodeDecimal24(loadUInt24<order>(bytes)));
+    else
+        return loadValue<order, T>(bytes);
+}
+
+template<ByteOrder order, RecordEncoding encoding, typename T> void storeField(T value, char* bytes)
+{
+    if constexpr (encoding == RecordEncoding::INT24)
+        storeUInt24<order>(static_cast<uint32_t>(value), bytes);
+    else if constexpr (encoding == RecordEncoding::INT24_SIGN_MAGNITUDE)
+        storeUInt24<order>(static_cast<uint32_t>(value < 0 ? -value : value) | (value < 0 ? 0x800000 : 0), bytes);
+    else if constexpr (encoding == RecordEncoding::UINT24)
+        storeUInt24<order>(value, bytes);
+    else if constexpr (encoding == RecordEncoding::DECIMAL24)
+        storeUInt24<order>(encodeDecimal24(static_cast<float>(value)), bytes);
+    else
+        storeValue<order>(value, bytes);
+}
+
+/*
+ * Decodes a whole file of generated records, e.g. read with a single read call. Records stored exactly like in memory
+ * are copied at once, all others get decoded in one pass of fully inlined field conversions.
+ */
+template<typename Record> std::vector<Record> decodeRecords(std::span<const char> bytes)
+{
+    if (bytes.size() % Record::ENCODED_SIZE != 0)
+        throw std::runtime_error("File size is not a multiple of the record size.");
+
+    std::vector<Record> records(bytes.size() / Record::ENCODED_SIZE);
+    if constexpr (Record::IS_NATIVE)
+        std::memcpy(records.data(), bytes.data(), bytes.size());
+    else
+        for (std::size_t i = 0; i < records.size(); i++)
+            records[i] = Record::decode(bytes.subspan(i * Record::ENCODED_SIZE).template first<Record::ENCODED_SIZE>());
+
+    return records;
+}
+
+template<typename Record> std::vector<char> encodeRecords(std::span<const Record> records)
+{
+    std::vector<char> bytes(records.size() * Record::ENCODED_SIZE);
+    if constexpr (Record::IS_NATIVE)
+        std::memcpy(bytes.data(), records.data(), bytes.size());
+    else
+        for (std::size_t i = 0; i < records.size(); i++)
+        {
+            auto encoded = std::span(bytes).subspan(i * Record::ENCODED_SIZE);
+            records[i].encode(encoded.template first<Record::ENCODED_SIZE>());
+        }
+
+    return bytes;
+}
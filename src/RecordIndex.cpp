@@ -0,0 +1,157 @@
+#include "RecordIndex.hpp"
+
+#include "FileStream.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+
+constexpr std::array<char, 8> INDEX_MAGIC = { 'B', 'D', 'C', 'I', 'D', 'X', '0', '2' };
+constexpr uint64_t SAMPLE_SIZE            = 64 * 1024;
+
+FileFingerprint fingerprintFile(const std::filesystem::path& path, const Structure& structure, uint64_t startOffset)
+{
+    FileFingerprint fingerprint;
+    fingerprint.fileSize      = std::filesystem::file_size(path);
+    fingerprint.structureHash = structure.getHash();
+    fingerprint.startOffset   = startOffset;
+    fingerprint.modifiedTime  = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    std::vector<char> buffer(SAMPLE_SIZE);
+    uint64_t hash = fnv1a(&fingerprint.fileSize, sizeof(fingerprint.fileSize));
+
+    auto size = fingerprint.fileSize;
+    for (uint64_t sampleStart : { uint64_t(0), size / 2, size > SAMPLE_SIZE ? size - SAMPLE_SIZE : uint64_t(0) })
+    {
+        auto sampleSize = std::min(SAMPLE_SIZE, size - sampleStart);
+        stream.seekg(sampleStart);
+        if (!stream.read(buffer.data(), sampleSize)) throw std::runtime_error("Could not read file: " + path.string());
+        hash = fnv1a(buffer.data(), sampleSize, hash);
+    }
+
+    fingerprint.sampleHash = hash;
+    return fingerprint;
+}
+
+uint64_t getStride(Reader& reader, const Structure& structure)
+{
+    uint64_t stride = 0;
+    for (auto& field : structure.getFields())
+    {
+        auto size = reader.getFieldSize(field.type);
+        if (size == 0) return 0;
+        stride += size;
+    }
+
+    return stride;
+}
+
+RecordIndex::RecordIndex(FileFingerprint fingerprint)
+    : fingerprint(fingerprint)
+{
+}
+
+RecordIndex RecordIndex::fixed(uint64_t fileSize, uint64_t startOffset, uint64_t stride, uint64_t maxEntryCount)
+{
+    FileFingerprint fingerprint;
+    fingerprint.fileSize    = fileSize;
+    fingerprint.startOffset = startOffset;
+
+    RecordIndex index(fingerprint);
+    index.stride     = stride;
+    index.entryCount = (fingerprint.fileSize - std::min(fingerprint.fileSize, fingerprint.startOffset)) / stride;
+    if (maxEntryCount != 0) index.entryCount = std::min(index.entryCount, maxEntryCount);
+
+    return index;
+}
+
+RecordIndex RecordIndex::scan(Reader& reader, const Structure& structure, FileFingerprint fingerprint)
+{
+    RecordIndex index(fingerprint);
+    reader.setPosition(fingerprint.startOffset);
+
+    while (reader.hasNext())
+    {
+        auto position = reader.getPosition();
+        if (position >= fingerprint.fileSize) break;
+
+        index.addEntry(position);
+        for (auto& field : structure.getFields())
+            reader.skip(field.type);
+    }
+
+    index.finish(std::min<uint64_t>(reader.getPosition(), fingerprint.fileSize));
+    return index;
+}
+
+std::optional<RecordIndex> RecordIndex::load(const std::filesystem::path& path, const FileFingerprint& expected)
+{
+    if (!std::filesystem::is_regular_file(path)) return std::nullopt;
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    std::array<char, 8> magic;
+    FileFingerprint fingerprint;
+    uint64_t entryCount = 0;
+
+    stream.read(magic.data(), magic.size());
+    stream.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+    stream.read(reinterpret_cast<char*>(&entryCount), sizeof(entryCount));
+
+    if (!stream || magic != INDEX_MAGIC || fingerprint != expected) return std::nullopt;
+
+    // a truncated or corrupted index must not size the offsets
+    auto headerSize = INDEX_MAGIC.size() + sizeof(fingerprint) + sizeof(entryCount);
+    auto indexSize  = std::filesystem::file_size(path);
+    if (entryCount >= (indexSize - headerSize) / sizeof(uint64_t) ||
+        indexSize != headerSize + (entryCount + 1) * sizeof(uint64_t))
+        return std::nullopt;
+
+    RecordIndex index(fingerprint);
+    index.entryCount = entryCount;
+    index.offsets.resize(entryCount + 1);
+    stream.read(reinterpret_cast<char*>(index.offsets.data()), index.offsets.size() * sizeof(uint64_t));
+
+    if (!stream || !std::is_sorted(index.offsets.begin(), index.offsets.end()) ||
+        index.offsets.back() > fingerprint.fileSize)
+        return std::nullopt;
+
+    return index;
+}
+
+void RecordIndex::save(const std::filesystem::path& path) const
+{
+    if (isFixed()) return;
+
+    OutputFile file({}, path.string(), std::ios::out | std::ios::binary);
+    std::ostream stream(file.get());
+    stream.write(INDEX_MAGIC.data(), INDEX_MAGIC.size());
+    stream.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    stream.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+    stream.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+
+    if (!stream) throw std::runtime_error("Could not write record index: " + path.string());
+    file.commit();
+}
+
+void RecordIndex::addEntry(uint64_t offset)
+{
+    offsets.push_back(offset);
+    entryCount++;
+}
+
+void RecordIndex::finish(uint64_t endOffset) { offsets.push_back(endOffset); }
+
+bool RecordIndex::isFixed() const { return stride != 0; }
+std::size_t RecordIndex::getEntryCount() const { return entryCount; }
+const FileFingerprint& RecordIndex::getFingerprint() const { return fingerprint; }
+
+uint64_t RecordIndex::getOffset(std::size_t entry) const
+{
+    if (entry > entryCount) throw std::runtime_error("Record index out of range.");
+    if (isFixed()) return fingerprint.startOffset + entry * stride;
+
+    return offsets[entry];
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+
+#include <filesystem>
+#include <optional>
+
+struct FileFingerprint
+{
+    uint64_t fileSize      = 0;
+    int64_t modifiedTime   = 0;
+    uint64_t sampleHash    = 0;
+    uint64_t structureHash = 0;
+    uint64_t startOffset   = 0;
+
+    bool operator==(const FileFingerprint& other) const = default;
+};
+
+/*
+ * The file size, its modification time and a hash of its first, middle and last 64 KB, so a sidecar isn't used for a
+ * file that was replaced or edited in place, without reading the whole file.
+ */
+FileFingerprint fingerprintFile(const std::filesystem::path& path, const Structure& structure, uint64_t startOffset);
+
+/*
+ * Maps record numbers to byte offsets, so single records can be decoded without touching the ones before them.
+ * Fixed-width structures don't need any stored offsets, those are computed from the stride instead.
+ */
+class RecordIndex
+{
+    FileFingerprint fingerprint;
+    std::vector<uint64_t> offsets{}; // record start offsets, followed by the end of the last record
+    uint64_t stride     = 0;
+    uint64_t entryCount = 0;
+
+public:
+    RecordIndex(FileFingerprint fingerprint);
+
+    // only knows the size of the file, as nothing gets stored for it
+    static RecordIndex fixed(uint64_t fileSize, uint64_t startOffset, uint64_t stride, uint64_t maxEntryCount);
+    static RecordIndex scan(Reader& reader, const Structure& structure, FileFingerprint fingerprint);
+    static std::optional<RecordIndex> load(const std::filesystem::path& path, const FileFingerprint& expected);
+    void save(const std::filesystem::path& path) const;
+
+    void addEntry(uint64_t offset);
+    void finish(uint64_t endOffset);
+
+    bool isFixed() const;
+    std::size_t getEntryCount() const;
+    uint64_t getOffset(std::size_t entry) const;
+    const FileFingerprint& getFingerprint() const;
+};
+
+/*
+ * Returns the stride of a structure if every field has a fixed size for the given reader, 0 otherwise.
+ */
+uint64_t getStride(Reader& reader, const Structure& structure);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+constexpr std::size_t ROW_ARENA_SIZE = 64 * 1024;
+
+/*
+ * Memory for the strings and arrays of a single row, released as a whole once the row has been written.
+ * Rows that don't fit into the inline buffer overflow into a pool, which keeps its blocks for the next rows,
+ * so converting a table only touches the heap while its rows keep growing.
+ */
+class RowArena
+{
+    std::array<std::byte, ROW_ARENA_SIZE> buffer;
+    std::pmr::unsynchronized_pool_resource pool{ { 0, 16 * ROW_ARENA_SIZE } };
+    std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), &pool };
+
+public:
+    RowArena()                           = default;
+    RowArena(const RowArena&)            = delete;
+    RowArena& operator=(const RowArena&) = delete;
+
+    std::pmr::memory_resource* get() { return &resource; }
+    void reset() { resource.release(); }
+};
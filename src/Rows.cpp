@@ -0,0 +1,73 @@
+#include "Rows.hpp"
+
+#include "AllocationStats.hpp"
+#include "ReadWriter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // the row lives in the coroutine frame, so its storage is reused for every entry
+    LazyRange<Row> decodeRows(Reader& reader, Row row)
+    {
+        while (reader.hasNext())
+        {
+            row.read(reader);
+            co_yield row;
+        }
+    }
+} // namespace
+
+Row::Row(const Structure& structure, const std::vector<std::string>& columns)
+    : structure(structure)
+    , values(structure.getFieldCount())
+    , isRead(structure.getFieldCount(), columns.empty())
+{
+    for (auto& column : columns)
+        isRead[getFieldIndex(column)] = true;
+}
+
+void Row::read(Reader& reader)
+{
+    auto& fields = structure.getFields();
+    for (std::size_t i = 0; i < fields.size(); i++)
+    {
+        AllocationField scope(fields[i].type);
+        if (isRead[i])
+            getReadWriter(fields[i].type).read(reader, values[i]);
+        else
+            reader.skip(fields[i].type);
+    }
+
+    countAllocationEntry();
+    readCount++;
+}
+
+const Structure& Row::getStructure() const { return structure; }
+uint64_t Row::getIndex() const { return readCount - 1; }
+
+std::size_t Row::getFieldIndex(std::string_view name) const
+{
+    auto& fields = structure.getFields();
+    auto it      = std::find_if(fields.begin(), fields.end(), [&](auto& field) { return field.name == name; });
+    if (it == fields.end()) throw std::runtime_error("Unknown field: " + std::string(name));
+
+    return it - fields.begin();
+}
+
+const Value& Row::operator[](std::size_t field) const
+{
+    if (field >= values.size()) throw std::out_of_range("Field index out of range.");
+    if (!isRead[field]) throw std::runtime_error("Field was not read: " + structure.getFields()[field].name);
+
+    return values[field];
+}
+
+const Value& Row::operator[](std::string_view name) const { return (*this)[getFieldIndex(name)]; }
+
+LazyRange<Row> readRows(Reader& reader, const Structure& structure, const std::vector<std::string>& columns)
+{
+    // unknown columns throw here instead of on the first step
+    return decodeRows(reader, Row(structure, columns));
+}
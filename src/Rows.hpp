@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "LazyRange.hpp"
+#include "Structure.hpp"
+#include "Value.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/*
+ * A single entry, decoded field by field. Reading the next entry reuses the values and their buffers, so strings and
+ * arrays only allocate when they outgrow the largest one so far. Fields that aren't selected are skipped.
+ */
+class Row
+{
+    Structure structure;
+    std::vector<Value> values{};
+    std::vector<bool> isRead{};
+    uint64_t readCount = 0;
+
+public:
+    // selects all fields when no columns are given, throws for unknown ones
+    Row(const Structure& structure, const std::vector<std::string>& columns = {});
+
+    // decodes the next entry of the reader over the previous one
+    void read(Reader& reader);
+
+    const Structure& getStructure() const;
+    // position of the entry in the file, counted from 0
+    uint64_t getIndex() const;
+
+    // throw for unknown and skipped fields
+    std::size_t getFieldIndex(std::string_view name) const;
+    const Value& operator[](std::size_t field) const;
+    const Value& operator[](std::string_view name) const;
+
+    // e.g. get<int32_t>("hpMax") for an int24 field or get<std::pmr::string>("nameText")
+    template<typename T> const T& get(std::string_view name) const { return std::get<T>((*this)[name]); }
+};
+
+/*
+ * Decodes the entries of the reader lazily, one per step of the range, e.g. in a range-for loop or through
+ * std::views::filter and std::views::take. Entries after the last one that was looked at are never read. Every step
+ * hands out the same row, which is only valid until the next one. The reader has to outlive the range.
+ */
+LazyRange<Row> readRows(Reader& reader, const Structure& structure, const std::vector<std::string>& columns = {});
@@ -0,0 +1,357 @@
+#include "SQLiteChannel.hpp"
+
+#include "Trace.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <sqlite3.h>
+
+constexpr int64_t PAGE_CACHE_SIZE_KB = 64 * 1024;
+
+namespace
+{
+    std::string getTableName(boost::json::object& config)
+    {
+        if (!config["table"].is_null()) return std::string(config["table"].as_string());
+
+        return std::filesystem::path(std::string(config["path"].as_string())).stem().string();
+    }
+
+    std::string quoteIdentifier(std::string_view name)
+    {
+        std::string quoted = "\"";
+        for (auto c : name)
+        {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+
+        return quoted + '"';
+    }
+
+    const char* getColumnType(FieldType type)
+    {
+        switch (type)
+        {
+            case FieldType::FLOAT:
+            case FieldType::DOUBLE: return "REAL";
+            case FieldType::STRING:
+            case FieldType::INT24ARRAY:
+            case FieldType::INT32ARRAY:
+            case FieldType::UINT24ARRAY:
+            case FieldType::UINT32ARRAY:
+            case FieldType::FLOATARRAY:
+            case FieldType::DOUBLEARRAY: return "TEXT";
+            default: return "INTEGER";
+        }
+    }
+
+    void check(sqlite3* database, int32_t result)
+    {
+        if (result != SQLITE_OK) throw std::runtime_error("SQLite error: " + std::string(sqlite3_errmsg(database)));
+    }
+
+    sqlite3* openDatabase(const std::string& path, int32_t flags)
+    {
+        sqlite3* database = nullptr;
+        auto result       = sqlite3_open_v2(path.c_str(), &database, flags, nullptr);
+        if (result != SQLITE_OK)
+        {
+            std::string message = database ? sqlite3_errmsg(database) : sqlite3_errstr(result);
+            sqlite3_close(database);
+            throw std::runtime_error("Could not open database " + path + ": " + message);
+        }
+
+        return database;
+    }
+} // namespace
+
+SQLiteReader::SQLiteReader(boost::json::object config, const Structure& structure)
+    : database(openDatabase(std::string(config["path"].as_string()), SQLITE_OPEN_READONLY))
+{
+    std::string columns;
+    for (auto& field : structure.getFields())
+    {
+        if (!columns.empty()) columns += ", ";
+        columns += quoteIdentifier(field.name);
+        names.push_back(field.name);
+    }
+
+    // the fields by name, so the order of the table columns doesn't matter, rows in the order they were inserted
+    auto sql    = "SELECT " + columns + " FROM " + quoteIdentifier(getTableName(config)) + " ORDER BY rowid";
+    auto result = sqlite3_prepare_v2(database, sql.c_str(), -1, &select, nullptr);
+    if (result != SQLITE_OK)
+    {
+        std::string message = sqlite3_errmsg(database);
+        sqlite3_close(database);
+        throw std::runtime_error("SQLite error: " + message);
+    }
+
+    // SQLite reads a quoted name that is no column as a string literal, its result column is named differently
+    for (int32_t i = 0; i < static_cast<int32_t>(names.size()); i++)
+    {
+        auto name = sqlite3_column_name(select, i);
+        if (name && names[i] == name) continue;
+
+        sqlite3_finalize(select);
+        sqlite3_close(database);
+        throw std::runtime_error("SQLite error: no such column: " + names[i]);
+    }
+}
+
+SQLiteReader::~SQLiteReader()
+{
+    sqlite3_finalize(select);
+    sqlite3_close(database);
+}
+
+// the index of the next column, NULL has no value for any field type
+int32_t SQLiteReader::nextColumn()
+{
+    if (sqlite3_column_type(select, currentColumn) == SQLITE_NULL)
+        throw std::runtime_error("SQLite error: NULL value in column " + names[currentColumn]);
+
+    return currentColumn++;
+}
+
+int64_t SQLiteReader::readInteger() { return sqlite3_column_int64(select, nextColumn()); }
+
+int8_t SQLiteReader::readInt8() { return static_cast<int8_t>(readInteger()); }
+int16_t SQLiteReader::readInt16() { return static_cast<int16_t>(readInteger()); }
+int32_t SQLiteReader::readInt24() { return static_cast<int32_t>((readInteger() << 40) >> 40); }
+int32_t SQLiteReader::readInt32() { return static_cast<int32_t>(readInteger()); }
+
+uint8_t SQLiteReader::readUInt8() { return static_cast<uint8_t>(readInteger()); }
+uint16_t SQLiteReader::readUInt16() { return static_cast<uint16_t>(readInteger()); }
+uint32_t SQLiteReader::readUInt24() { return static_cast<uint32_t>(readInteger()) & 0xFFFFFF; }
+uint32_t SQLiteReader::readUInt32() { return static_cast<uint32_t>(readInteger()); }
+
+uint8_t SQLiteReader::readHex8() { return readUInt8(); }
+uint16_t SQLiteReader::readHex16() { return readUInt16(); }
+uint32_t SQLiteReader::readHex32() { return readUInt32(); }
+
+float SQLiteReader::readFloat() { return readReal<float>(); }
+double SQLiteReader::readDouble() { return readReal<double>(); }
+
+// NaN is stored as the bytes of the value, SQLite would turn it into NULL
+template<typename T> T SQLiteReader::readReal()
+{
+    auto column = nextColumn();
+    if (sqlite3_column_type(select, column) != SQLITE_BLOB)
+        return static_cast<T>(sqlite3_column_double(select, column));
+
+    T value;
+    auto bytes = sqlite3_column_blob(select, column);
+    if (sqlite3_column_bytes(select, column) != sizeof(T))
+        throw std::runtime_error("SQLite error: invalid value in column " + names[column]);
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+void SQLiteReader::readString(std::pmr::string& value)
+{
+    auto column = nextColumn();
+    auto text   = reinterpret_cast<const char*>(sqlite3_column_text(select, column));
+    value.assign(text ? text : "", sqlite3_column_bytes(select, column));
+}
+
+void SQLiteReader::readInt24Array(std::pmr::vector<int32_t>& values) { readArray(values); }
+void SQLiteReader::readInt32Array(std::pmr::vector<int32_t>& values) { readArray(values); }
+void SQLiteReader::readUInt24Array(std::pmr::vector<uint32_t>& values) { readArray(values); }
+void SQLiteReader::readUInt32Array(std::pmr::vector<uint32_t>& values) { readArray(values); }
+void SQLiteReader::readFloatArray(std::pmr::vector<float>& values) { readArray(values); }
+void SQLiteReader::readDoubleArray(std::pmr::vector<double>& values) { readArray(values); }
+
+bool SQLiteReader::hasNext()
+{
+    currentColumn = 0;
+
+    auto result = sqlite3_step(select);
+    if (result == SQLITE_ROW) return true;
+    if (result == SQLITE_DONE) return false;
+
+    throw std::runtime_error("SQLite error: " + std::string(sqlite3_errmsg(database)));
+}
+
+// JSON arrays of numbers, e.g. [1,2,3]
+template<typename T> void SQLiteReader::readArray(std::pmr::vector<T>& values)
+{
+    values.clear();
+    auto column = nextColumn();
+    auto it     = reinterpret_cast<const char*>(sqlite3_column_text(select, column));
+    auto end    = it + sqlite3_column_bytes(select, column);
+
+    while (it != end)
+    {
+        if (*it == '[' || *it == ']' || *it == ',' || *it == ' ')
+        {
+            it++;
+            continue;
+        }
+
+        T value;
+        auto result = std::from_chars(it, end, value);
+        if (result.ec != std::errc()) throw std::runtime_error("Invalid array value: " + std::string(it, end));
+
+        values.push_back(value);
+        it = result.ptr;
+    }
+}
+
+// Random Access Functions
+std::size_t SQLiteReader::getFieldSize(FieldType type) { return 0; }
+void SQLiteReader::skip(FieldType type) { currentColumn++; }
+std::size_t SQLiteReader::getPosition()
+{
+    throw std::runtime_error("Unimplemented Feature: SQLiteReader::getPosition");
+}
+void SQLiteReader::setPosition(std::size_t position)
+{
+    throw std::runtime_error("Unimplemented Feature: SQLiteReader::setPosition");
+}
+
+SQLiteWriter::SQLiteWriter(boost::json::object config)
+    : database(openDatabase(std::string(config["path"].as_string()), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE))
+    , table(getTableName(config))
+{
+    // bulk load, the write-ahead log is only synced at checkpoints, a power loss may undo the last commit but can't
+    // corrupt the database
+    try
+    {
+        execute("PRAGMA journal_mode = WAL");
+        execute("PRAGMA synchronous = NORMAL");
+        execute("PRAGMA cache_size = " + std::to_string(-PAGE_CACHE_SIZE_KB));
+    }
+    catch (...)
+    {
+        sqlite3_close(database);
+        throw;
+    }
+}
+
+SQLiteWriter::~SQLiteWriter()
+{
+    sqlite3_finalize(insert);
+    if (!isCommitted && !sqlite3_get_autocommit(database))
+        sqlite3_exec(database, "ROLLBACK", nullptr, nullptr, nullptr);
+    sqlite3_close(database);
+}
+
+void SQLiteWriter::execute(const std::string& sql)
+{
+    check(database, sqlite3_exec(database, sql.c_str(), nullptr, nullptr, nullptr));
+}
+
+void SQLiteWriter::bindInteger(int64_t value) { check(database, sqlite3_bind_int64(insert, ++currentColumn, value)); }
+
+template<typename T> void SQLiteWriter::bindNaN(T value)
+{
+    check(database, sqlite3_bind_blob(insert, ++currentColumn, &value, sizeof(T), SQLITE_TRANSIENT));
+}
+
+// Write Functions
+void SQLiteWriter::writeInt8(std::string_view name, int8_t value) { bindInteger(value); }
+void SQLiteWriter::writeInt16(std::string_view name, int16_t value) { bindInteger(value); }
+void SQLiteWriter::writeInt24(std::string_view name, int32_t value) { bindInteger(value); }
+void SQLiteWriter::writeInt32(std::string_view name, int32_t value) { bindInteger(value); }
+
+void SQLiteWriter::writeUInt8(std::string_view name, uint8_t value) { bindInteger(value); }
+void SQLiteWriter::writeUInt16(std::string_view name, uint16_t value) { bindInteger(value); }
+void SQLiteWriter::writeUInt24(std::string_view name, uint32_t value) { bindInteger(value); }
+void SQLiteWriter::writeUInt32(std::string_view name, uint32_t value) { bindInteger(value); }
+
+void SQLiteWriter::writeHex8(std::string_view name, uint8_t value) { bindInteger(value); }
+void SQLiteWriter::writeHex16(std::string_view name, uint16_t value) { bindInteger(value); }
+void SQLiteWriter::writeHex32(std::string_view name, uint32_t value) { bindInteger(value); }
+
+void SQLiteWriter::writeFloat(std::string_view name, float value)
+{
+    if (std::isnan(value)) return bindNaN(value);
+
+    // the double closest to the shortest decimal form, so 0.1f is stored as 0.1 and still reads back as 0.1f
+    std::array<char, 32> buffer;
+    auto end     = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value).ptr;
+    double exact = 0.0;
+    std::from_chars(buffer.data(), end, exact);
+    check(database, sqlite3_bind_double(insert, ++currentColumn, exact));
+}
+void SQLiteWriter::writeDouble(std::string_view name, double value)
+{
+    if (std::isnan(value)) return bindNaN(value);
+    check(database, sqlite3_bind_double(insert, ++currentColumn, value));
+}
+void SQLiteWriter::writeString(std::string_view name, std::string_view value)
+{
+    check(database,
+          sqlite3_bind_text(insert, ++currentColumn, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT));
+}
+
+void SQLiteWriter::writeInt24Array(std::string_view name, std::span<const int32_t> values) { writeArray(values); }
+void SQLiteWriter::writeInt32Array(std::string_view name, std::span<const int32_t> values) { writeArray(values); }
+void SQLiteWriter::writeUInt24Array(std::string_view name, std::span<const uint32_t> values) { writeArray(values); }
+void SQLiteWriter::writeUInt32Array(std::string_view name, std::span<const uint32_t> values) { writeArray(values); }
+void SQLiteWriter::writeFloatArray(std::string_view name, std::span<const float> values) { writeArray(values); }
+void SQLiteWriter::writeDoubleArray(std::string_view name, std::span<const double> values) { writeArray(values); }
+
+template<typename T> void SQLiteWriter::writeArray(std::span<const T> values)
+{
+    arrayBuffer = "[";
+    std::array<char, 32> buffer;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        if (i != 0) arrayBuffer += ',';
+        auto end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), values[i]).ptr;
+        arrayBuffer.append(buffer.data(), end);
+    }
+    arrayBuffer += ']';
+
+    writeString({}, arrayBuffer);
+}
+
+// Structure Functions
+void SQLiteWriter::startFile(boost::json::object structure)
+{
+    std::string columns;
+    std::string parameters;
+    for (auto& entry : structure)
+    {
+        if (!columns.empty())
+        {
+            columns += ", ";
+            parameters += ", ";
+        }
+        auto type = toFieldType(std::string(entry.value().as_string()));
+        columns += quoteIdentifier(entry.key()) + " " + getColumnType(type);
+        parameters += "?";
+    }
+
+    // an existing table only gets replaced once the whole file has been written
+    execute("BEGIN");
+    execute("DROP TABLE IF EXISTS " + quoteIdentifier(table));
+    execute("CREATE TABLE " + quoteIdentifier(table) + " (" + columns + ")");
+
+    auto sql = "INSERT INTO " + quoteIdentifier(table) + " VALUES (" + parameters + ")";
+    check(database, sqlite3_prepare_v2(database, sql.c_str(), -1, &insert, nullptr));
+}
+void SQLiteWriter::startEntry() { currentColumn = 0; }
+void SQLiteWriter::finishEntry()
+{
+    if (sqlite3_step(insert) != SQLITE_DONE)
+        throw std::runtime_error("SQLite error: " + std::string(sqlite3_errmsg(database)));
+
+    sqlite3_reset(insert);
+}
+void SQLiteWriter::finishFile()
+{
+    TraceSpan span("commit");
+    sqlite3_finalize(insert);
+    insert = nullptr;
+
+    execute("COMMIT");
+    isCommitted = true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+
+#include <boost/json.hpp>
+
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/*
+ * Tables in an SQLite database, so the data can be queried with SQL. The "table" key of the channel config names the
+ * table, by default it is named like the file without extension. Integers and hex values are stored as INTEGER,
+ * floats as REAL, strings as TEXT and arrays as JSON arrays in TEXT, which can be queried with json_each. NaN is
+ * stored as a BLOB of its bytes, as SQLite would turn it into NULL. SQLite stores -0.0 as 0, all other values read
+ * back exactly as written. The reader selects the fields of the structure by
+ * name and fails on missing columns and NULL values.
+ */
+class SQLiteReader : public Reader
+{
+private:
+    sqlite3* database     = nullptr;
+    sqlite3_stmt* select  = nullptr;
+    std::vector<std::string> names;
+    int32_t currentColumn = 0;
+
+    int32_t nextColumn();
+    int64_t readInteger();
+    template<typename T> T readReal();
+    template<typename T> void readArray(std::pmr::vector<T>& values);
+
+public:
+    SQLiteReader(boost::json::object config, const Structure& structure);
+    ~SQLiteReader();
+
+    SQLiteReader(const SQLiteReader&)            = delete;
+    SQLiteReader& operator=(const SQLiteReader&) = delete;
+
+    // Read Functions
+    virtual int8_t readInt8();
+    virtual int16_t readInt16();
+    virtual int32_t readInt24();
+    virtual int32_t readInt32();
+
+    virtual uint8_t readUInt8();
+    virtual uint16_t readUInt16();
+    virtual uint32_t readUInt24();
+    virtual uint32_t readUInt32();
+
+    virtual uint8_t readHex8();
+    virtual uint16_t readHex16();
+    virtual uint32_t readHex32();
+
+    virtual float readFloat();
+    virtual double readDouble();
+
+    virtual void readString(std::pmr::string& value);
+
+    virtual void readInt24Array(std::pmr::vector<int32_t>& values);
+    virtual void readInt32Array(std::pmr::vector<int32_t>& values);
+    virtual void readUInt24Array(std::pmr::vector<uint32_t>& values);
+    virtual void readUInt32Array(std::pmr::vector<uint32_t>& values);
+    virtual void readFloatArray(std::pmr::vector<float>& values);
+    virtual void readDoubleArray(std::pmr::vector<double>& values);
+
+    virtual bool hasNext();
+
+    // Random Access Functions
+    virtual std::size_t getFieldSize(FieldType type);
+    virtual void skip(FieldType type);
+    virtual std::size_t getPosition();
+    virtual void setPosition(std::size_t position);
+};
+
+/*
+ * Replaces the table with one created from the structure and inserts all entries through a single prepared statement
+ * inside one transaction, so a failed conversion leaves the database as it was. For the bulk load the database uses a
+ * write-ahead log that is only synced at checkpoints and a larger page cache. A crash can undo the last conversion,
+ * but never corrupts the database.
+ */
+class SQLiteWriter : public Writer
+{
+private:
+    sqlite3* database    = nullptr;
+    sqlite3_stmt* insert = nullptr;
+    std::string table;
+    std::string arrayBuffer{};
+    int32_t currentColumn = 0;
+    bool isCommitted      = false;
+
+    void execute(const std::string& sql);
+    void bindInteger(int64_t value);
+    template<typename T> void bindNaN(T value);
+    template<typename T> void writeArray(std::span<const T> values);
+
+public:
+    SQLiteWriter(boost::json::object config);
+    ~SQLiteWriter();
+
+    SQLiteWriter(const SQLiteWriter&)            = delete;
+    SQLiteWriter& operator=(const SQLiteWriter&) = delete;
+
+    // Write Functions
+    virtual void writeInt8(std::string_view name, int8_t value);
+    virtual void writeInt16(std::string_view name, int16_t value);
+    virtual void writeInt24(std::string_view name, int32_t value);
+    virtual void writeInt32(std::string_view name, int32_t value);
+
+    virtual void writeUInt8(std::string_view name, uint8_t value);
+    virtual void writeUInt16(std::string_view name, uint16_t value);
+    virtual void writeUInt24(std::string_view name, uint32_t value);
+    virtual void writeUInt32(std::string_view name, uint32_t value);
+
+    virtual void writeHex8(std::string_view name, uint8_t value);
+    virtual void writeHex16(std::string_view name, uint16_t value);
+    virtual void writeHex32(std::string_view name, uint32_t value);
+
+    virtual void writeFloat(std::string_view name, float value);
+    virtual void writeDouble(std::string_view name, double value);
+    virtual void writeString(std::string_view name, std::string_view value);
+
+    virtual void writeInt24Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeInt32Array(std::string_view name, std::span<const int32_t> values);
+    virtual void writeUInt24Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeUInt32Array(std::string_view name, std::span<const uint32_t> values);
+    virtual void writeFloatArray(std::string_view name, std::span<const float> values);
+    virtual void writeDoubleArray(std::string_view name, std::span<const double> values);
+
+    // Structure Functions
+    virtual void startFile(boost::json::object structure);
+    virtual void startEntry();
+    virtual void finishEntry();
+    virtual void finishFile();
+};
@@ -0,0 +1,327 @@
+#include "Segments.hpp"
+
+#include "ChannelFactory.hpp"
+#include "FileStream.hpp"
+#ifdef BDC_MMAP
+    #include "MappedStream.hpp"
+#endif
+#include "ReadWriter.hpp"
+#include "RecordIndex.hpp"
+#include "RowArena.hpp"
+#include "Structure.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t SEGMENT_COPY_BLOCK_SIZE = 1024 * 1024;
+
+namespace
+{
+    struct Segment
+    {
+        boost::json::object input;
+        boost::json::object output;
+        boost::json::object structure;
+        uint64_t offset     = 0;
+        uint64_t entryCount = 0;
+    };
+
+    std::vector<Segment> parseSegments(const boost::json::object& input, const boost::json::array& segments)
+    {
+        if (!getChannelBinaryFormat(input)) throw std::runtime_error("Segments require a binary game file.");
+
+        std::vector<Segment> parsed;
+        for (std::size_t i = 0; i < segments.size(); i++)
+        {
+            auto& object = segments[i].as_object();
+
+            Segment segment;
+            segment.input = input;
+            if (auto overrides = object.if_contains("input"))
+                for (auto& entry : overrides->as_object())
+                    segment.input[entry.key()] = entry.value();
+
+            // without a count a segment would run into the next one
+            auto entryCount = object.if_contains("entryCount");
+            if (!entryCount || entryCount->to_number<int64_t>() <= 0)
+                throw std::runtime_error("Segment " + std::to_string(i) + " needs an entryCount.");
+
+            auto offset                 = object.if_contains("offset");
+            segment.offset              = offset ? offset->to_number<uint64_t>() : 0;
+            segment.entryCount          = entryCount->to_number<uint64_t>();
+            segment.input["offset"]     = static_cast<int64_t>(segment.offset);
+            segment.input["entryCount"] = static_cast<int64_t>(segment.entryCount);
+            segment.output              = object.at("output").as_object();
+            segment.structure           = object.at("structure").as_object();
+            parsed.push_back(std::move(segment));
+        }
+
+        return parsed;
+    }
+
+    // runs the task for every segment on up to threadCount threads, rethrows the first error once all are done
+    void forEachSegment(std::size_t count, std::size_t threadCount, const std::function<void(std::size_t)>& task)
+    {
+        std::atomic<std::size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+
+        auto worker = [&]()
+        {
+            for (auto i = next++; i < count; i = next++)
+            {
+                try
+                {
+                    TraceSpan span("segment", std::to_string(i));
+                    task(i);
+                }
+                catch (std::exception& ex)
+                {
+                    std::lock_guard lock(mutex);
+                    auto message = "Segment " + std::to_string(i) + ": " + ex.what();
+                    if (!error) error = std::make_exception_ptr(std::runtime_error(message));
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < std::min(threadCount, count); i++)
+            threads.emplace_back(worker);
+        for (auto& thread : threads)
+            thread.join();
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    // returns the number of entries converted
+    uint64_t convertSegment(const boost::json::object& structure, boost::json::object from, boost::json::object to)
+    {
+        Structure layout(structure);
+        std::unique_ptr<Reader> reader = readerFactory(from, layout);
+        std::unique_ptr<Writer> writer = writerFactory(to);
+        RowArena arena;
+
+        uint64_t count = 0;
+        writer->startFile(structure);
+        for (; reader->hasNext(); count++)
+        {
+            convertEntry(layout, *reader, *writer, arena.get());
+            arena.reset();
+        }
+        writer->finishFile();
+
+        return count;
+    }
+
+    // where the segment ends in the existing game file, only reads the sizes of variable size fields
+    uint64_t getSegmentEnd(const Segment& segment)
+    {
+        Structure layout(segment.structure);
+        auto config = segment.input;
+        config.erase("textPath");
+        std::unique_ptr<Reader> reader = readerFactory(config, layout);
+
+        if (auto stride = getStride(*reader, layout)) return segment.offset + stride * segment.entryCount;
+
+        uint64_t count = 0;
+        for (; reader->hasNext(); count++)
+            for (auto& field : layout.getFields())
+                reader->skip(field.type);
+
+        if (count != segment.entryCount) throw std::runtime_error("The game file ends inside of a segment.");
+        return reader->getPosition();
+    }
+
+    // copies count bytes, or everything that is left
+    void copyBytes(std::streambuf& from, std::streambuf& to, std::optional<uint64_t> count = std::nullopt)
+    {
+        std::vector<char> buffer(SEGMENT_COPY_BLOCK_SIZE);
+        auto left = count.value_or(std::numeric_limits<uint64_t>::max());
+        while (left > 0)
+        {
+            auto block = static_cast<std::streamsize>(std::min<uint64_t>(left, SEGMENT_COPY_BLOCK_SIZE));
+            auto size  = from.sgetn(buffer.data(), block);
+            if (size <= 0) break;
+            if (to.sputn(buffer.data(), size) != size) throw std::runtime_error("Could not write the game file.");
+            left -= size;
+        }
+
+        if (count && left != 0) throw std::runtime_error("The game file ends inside of a segment.");
+    }
+
+    /*
+     * Encoded segments next to the game file and their string tables next to the real ones, which keeps the extension
+     * of their compression. All of them get removed once the game file has been reassembled.
+     */
+    class SegmentFiles
+    {
+        std::vector<std::string> paths;
+        std::vector<std::string> textPaths;
+
+    public:
+        SegmentFiles(const std::string& path, const std::vector<std::string>& tables)
+        {
+            for (std::size_t i = 0; i < tables.size(); i++)
+            {
+                auto prefix = ".segment" + std::to_string(i) + ".";
+                paths.push_back(path + prefix + "tmp");
+
+                std::filesystem::path table(tables[i]);
+                auto textPath = table.parent_path() / (prefix + table.filename().string());
+                textPaths.push_back(tables[i].empty() ? "" : textPath.string());
+            }
+        }
+        ~SegmentFiles()
+        {
+            std::error_code error;
+            for (auto& path : paths)
+                std::filesystem::remove(path, error);
+            for (auto& path : textPaths)
+                if (!path.empty()) std::filesystem::remove(path, error);
+        }
+
+        SegmentFiles(const SegmentFiles&)            = delete;
+        SegmentFiles& operator=(const SegmentFiles&) = delete;
+
+        const std::string& get(std::size_t index) const { return paths[index]; }
+        const std::string& getText(std::size_t index) const { return textPaths[index]; }
+    };
+} // namespace
+
+void unpackSegments(const boost::json::object& input, const boost::json::array& segments, std::size_t threadCount)
+{
+    auto parsed = parseSegments(input, segments);
+    for (auto& segment : parsed)
+        if (!segment.input.contains("io")) segment.input["io"] = "mmap";
+
+#ifdef BDC_MMAP
+    // keeps the game file mapped until every segment is done, instead of mapping it for every reader
+    std::shared_ptr<MappedFile> mapping;
+    try
+    {
+        if (!input.contains("bundle")) mapping = openMappedFile(std::string(input.at("path").as_string()));
+    }
+    catch (std::runtime_error&)
+    {
+        // the readers fall back to the regular file buffer
+    }
+#endif
+
+    forEachSegment(parsed.size(),
+                   threadCount,
+                   [&](std::size_t i) { convertSegment(parsed[i].structure, parsed[i].input, parsed[i].output); });
+}
+
+void packSegments(const boost::json::object& input, const boost::json::array& segments, std::size_t threadCount)
+{
+    auto parsed = parseSegments(input, segments);
+    std::string path(input.at("path").as_string());
+    if (!inputExists(input, path)) throw std::runtime_error("Packing segments requires the existing game file.");
+
+    // the layout of the existing game file
+    std::vector<std::size_t> order(parsed.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](auto a, auto b) { return parsed[a].offset < parsed[b].offset; });
+
+    std::vector<uint64_t> ends(parsed.size());
+    forEachSegment(parsed.size(), threadCount, [&](std::size_t i) { ends[i] = getSegmentEnd(parsed[i]); });
+    for (std::size_t i = 1; i < order.size(); i++)
+        if (ends[order[i - 1]] > parsed[order[i]].offset)
+            throw std::runtime_error("Segments " + std::to_string(order[i - 1]) + " and " + std::to_string(order[i]) +
+                                     " overlap.");
+
+    // every segment writes its string table as a whole, so concurrent segments would overwrite each other's
+    std::vector<std::string> tables(parsed.size());
+    std::map<std::filesystem::path, std::size_t> textPaths;
+    for (std::size_t i = 0; i < parsed.size(); i++)
+    {
+        auto textPath = parsed[i].input.if_contains("textPath");
+        if (!textPath || textPath->is_null()) continue;
+        if (getChannelBinaryFormat(parsed[i].input)->stringEncoding != StringEncoding::TABLE) continue;
+
+        auto normalized = std::filesystem::absolute(std::string(textPath->as_string())).lexically_normal();
+        auto [it, isNew] = textPaths.emplace(normalized, i);
+        if (!isNew)
+            throw std::runtime_error("Segments " + std::to_string(it->second) + " and " + std::to_string(i) +
+                                     " share the string table " + normalized.string() +
+                                     ", packing needs a textPath for every segment.");
+        tables[i] = std::string(textPath->as_string());
+    }
+
+    SegmentFiles files(path, tables);
+    forEachSegment(parsed.size(),
+                   threadCount,
+                   [&](std::size_t i)
+                   {
+                       auto to = parsed[i].input;
+                       to["path"] = files.get(i);
+                       to.erase("offset");
+                       to.erase("entryCount");
+                       to.erase("compression");
+                       if (!tables[i].empty()) to["textPath"] = files.getText(i);
+
+                       // the entryCount of the structure file has to stay right for the next unpack
+                       auto count = convertSegment(parsed[i].structure, parsed[i].output, to);
+                       if (count != parsed[i].entryCount)
+                           throw std::runtime_error("The user file has " + std::to_string(count) +
+                                                    " entries, but the entryCount of the segment is " +
+                                                    std::to_string(parsed[i].entryCount) + ".");
+                   });
+
+    // the offsets of the structure file have to stay right as well, so only the last segment may change its size
+    uint64_t offset = 0;
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        auto segment = order[i];
+        offset += parsed[segment].offset - (i == 0 ? 0 : ends[order[i - 1]]);
+        if (offset != parsed[segment].offset)
+            throw std::runtime_error("Segment " + std::to_string(segment) + " would move to offset " +
+                                     std::to_string(offset) + ", as the size of the segments before it changed.");
+        offset += std::filesystem::file_size(files.get(segment));
+    }
+
+    TraceSpan span("reassemble", path);
+    {
+        auto original = openInputBuffer(input, path, std::ios::binary);
+        OutputFile file(input, path, std::ios::binary);
+
+        uint64_t position = 0; // in the existing game file
+        for (auto i : order)
+        {
+            copyBytes(*original, *file.get(), parsed[i].offset - position);
+
+            // the encoded segment replaces the old one
+            if (original->pubseekoff(ends[i] - parsed[i].offset, std::ios::cur, std::ios::in) == -1)
+                throw std::runtime_error("Could not read the game file.");
+            position = ends[i];
+
+            std::filebuf segmentFile;
+            if (!segmentFile.open(files.get(i), std::ios::in | std::ios::binary))
+                throw std::runtime_error("Could not open file: " + files.get(i));
+            copyBytes(segmentFile, *file.get());
+        }
+
+        copyBytes(*original, *file.get());
+        file.commit();
+    }
+
+    // the string tables only get replaced once they match the game file, segments without strings don't write one
+    for (std::size_t i = 0; i < parsed.size(); i++)
+        if (!tables[i].empty() && std::filesystem::exists(files.getText(i)))
+            std::filesystem::rename(files.getText(i), tables[i]);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <boost/json.hpp>
+
+#include <cstddef>
+
+/*
+ * Structure files with a "segments" array instead of a "structure" describe several tables inside one binary game
+ * file, which share its "input" section. Every segment has the "offset" and "entryCount" of its table, its "structure"
+ * and the "output" section of its user file. An optional "input" object overrides keys of the shared one for a single
+ * segment, e.g. the "textPath" of its string table.
+ *
+ * Unpacking maps the game file once and converts the segments concurrently on up to threadCount threads.
+ */
+void unpackSegments(const boost::json::object& input, const boost::json::array& segments, std::size_t threadCount);
+
+/*
+ * Encodes the segments concurrently and reassembles the game file in the same layout. The bytes before, between and
+ * after the segments are kept from the existing game file. Fails when a user file doesn't have the entryCount of its
+ * segment or when a segment would move, because one before it changed its encoded size. Segments with string tables
+ * need one of their own, as every segment writes its table as a whole. The tables are replaced after the game file.
+ */
+void packSegments(const boost::json::object& input, const boost::json::array& segments, std::size_t threadCount);
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+constexpr int32_t RING_SPIN_COUNT     = 256;
+
+/*
+ * Bounded lock-free queue between exactly one producer and one consumer thread. Slots are filled and consumed in
+ * place, so their memory gets reused for every lap around the ring. Both sides spin briefly before sleeping on the
+ * other side's counter, which only costs a syscall when a stage actually ran dry.
+ */
+template<typename T> class SpscRing
+{
+    static constexpr uint64_t CLOSED = uint64_t(1) << 63;
+
+    std::vector<T> slots;
+    uint64_t mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head = 0; // next slot to pop, only advanced by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail = 0; // next slot to push, only advanced by the producer
+
+    // the other side's counter as last seen, so the shared cache lines are only touched when the ring looks full/empty
+    alignas(CACHE_LINE_SIZE) uint64_t producerHead = 0;
+    alignas(CACHE_LINE_SIZE) uint64_t consumerTail = 0;
+
+    // waits until the counter differs from the given value
+    static void await(std::atomic<uint64_t>& counter, uint64_t value, int32_t& spins)
+    {
+        if (spins++ < RING_SPIN_COUNT) return;
+        counter.wait(value, std::memory_order_acquire);
+    }
+
+public:
+    // the capacity gets rounded up to a power of two
+    SpscRing(std::size_t capacity)
+        : slots(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+        , mask(slots.size() - 1)
+    {
+    }
+
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // the next free slot, waits while the ring is full and returns nullptr once it has been closed
+    T* beginPush()
+    {
+        auto position = tail.load(std::memory_order_relaxed) & ~CLOSED;
+        for (int32_t spins = 0;;)
+        {
+            if (position - producerHead < slots.size()) return &slots[position & mask];
+
+            auto current = head.load(std::memory_order_acquire);
+            if (current & CLOSED) return nullptr;
+            if (position - current < slots.size())
+                producerHead = current;
+            else
+                await(head, current, spins);
+        }
+    }
+
+    // publishes the slot returned by beginPush
+    void endPush()
+    {
+        tail.fetch_add(1, std::memory_order_release);
+        tail.notify_one();
+    }
+
+    // the next filled slot, waits while the ring is empty and returns nullptr once it has been closed and drained
+    T* beginPop()
+    {
+        auto position = head.load(std::memory_order_relaxed) & ~CLOSED;
+        for (int32_t spins = 0;;)
+        {
+            if (position != consumerTail) return &slots[position & mask];
+
+            auto current = tail.load(std::memory_order_acquire);
+            if ((current & ~CLOSED) != position)
+                consumerTail = current & ~CLOSED;
+            else if (current & CLOSED)
+                return nullptr;
+            else
+                await(tail, current, spins);
+        }
+    }
+
+    // releases the slot returned by beginPop for the producer
+    void endPop()
+    {
+        head.fetch_add(1, std::memory_order_release);
+        head.notify_one();
+    }
+
+    // waits until the consumer released every published slot, or closed the ring
+    void waitUntilEmpty()
+    {
+        auto position = tail.load(std::memory_order_relaxed) & ~CLOSED;
+        for (int32_t spins = 0;;)
+        {
+            auto current = head.load(std::memory_order_acquire);
+            if ((current & CLOSED) || current == position) return;
+            await(head, current, spins);
+        }
+    }
+
+    /*
+     * Called by the producer once it is done, the consumer still gets all published slots. Called by the consumer to
+     * abort, the producer's next beginPush returns nullptr.
+     */
+    void close()
+    {
+        head.fetch_or(CLOSED, std::memory_order_release);
+        tail.fetch_or(CLOSED, std::memory_order_release);
+        head.notify_all();
+        tail.notify_all();
+    }
+
+    // only while neither side is using the ring, keeps the slots
+    void reset()
+    {
+        head         = 0;
+        tail         = 0;
+        producerHead = 0;
+        consumerTail = 0;
+    }
+};
@@ -0,0 +1,65 @@
+#include "Structure.hpp"
+
+#include "Hash.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <map>
+#include <stdexcept>
+
+FieldType toFieldType(std::string type)
+{
+    static const std::map<std::string, FieldType> types = {
+        { "int8", FieldType::INT8 },
+        { "int16", FieldType::INT16 },
+        { "int24", FieldType::INT24 },
+        { "int32", FieldType::INT32 },
+        { "uint8", FieldType::UINT8 },
+        { "uint16", FieldType::UINT16 },
+        { "uint24", FieldType::UINT24 },
+        { "uint32", FieldType::UINT32 },
+        { "hex8", FieldType::HEX8 },
+        { "hex16", FieldType::HEX16 },
+        { "hex32", FieldType::HEX32 },
+        { "float", FieldType::FLOAT },
+        { "double", FieldType::DOUBLE },
+        { "string", FieldType::STRING },
+        { "int24array", FieldType::INT24ARRAY },
+        { "int32array", FieldType::INT32ARRAY },
+        { "uint24array", FieldType::UINT24ARRAY },
+        { "uint32array", FieldType::UINT32ARRAY },
+        { "floatarray", FieldType::FLOATARRAY },
+        { "doublearray", FieldType::DOUBLEARRAY },
+    };
+
+    boost::algorithm::to_lower(type);
+    auto it = types.find(type);
+    if (it == types.end()) throw std::runtime_error("Unknown field type: " + type);
+
+    return it->second;
+}
+
+Structure::Structure(const boost::json::object& structure)
+{
+    for (auto& entry : structure)
+    {
+        std::string type(entry.value().as_string());
+        boost::algorithm::to_lower(type);
+        fields.push_back({ std::string(entry.key()), type, toFieldType(type) });
+    }
+}
+
+const std::vector<Field>& Structure::getFields() const { return fields; }
+std::size_t Structure::getFieldCount() const { return fields.size(); }
+
+uint64_t Structure::getHash() const
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (auto& field : fields)
+    {
+        hash = fnv1a(field.name.data(), field.name.size(), hash);
+        hash = fnv1a(field.typeName.data(), field.typeName.size(), hash);
+    }
+
+    return hash;
+}
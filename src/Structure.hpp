@@ -0,0 +1,54 @@
+#pragma once
+
+#include <boost/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class FieldType
+{
+    INT8,
+    INT16,
+    INT24,
+    INT32,
+    UINT8,
+    UINT16,
+    UINT24,
+    UINT32,
+    HEX8,
+    HEX16,
+    HEX32,
+    FLOAT,
+    DOUBLE,
+    STRING,
+    INT24ARRAY,
+    INT32ARRAY,
+    UINT24ARRAY,
+    UINT32ARRAY,
+    FLOATARRAY,
+    DOUBLEARRAY,
+};
+
+FieldType toFieldType(std::string type);
+
+struct Field
+{
+    std::string name;
+    std::string typeName;
+    FieldType type;
+};
+
+class Structure
+{
+    std::vector<Field> fields;
+
+public:
+    Structure(const boost::json::object& structure);
+
+    const std::vector<Field>& getFields() const;
+    std::size_t getFieldCount() const;
+
+    // stable across runs and platforms, used to validate sidecar files
+    uint64_t getHash() const;
+};
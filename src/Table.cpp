@@ -0,0 +1,121 @@
+#include "Table.hpp"
+
+#include "AllocationStats.hpp"
+#include "ReadWriter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+Table::Table(const Structure& structure)
+    : structure(structure)
+    , arena(std::make_unique<std::pmr::monotonic_buffer_resource>())
+{
+    for (auto& field : structure.getFields())
+        columns.push_back(getReadWriter(field.type).makeColumn());
+}
+
+std::size_t Table::load(Reader& reader, std::size_t maxRows)
+{
+    auto& fields = structure.getFields();
+
+    std::vector<ReadWriter*> readWriters;
+    for (auto& field : fields)
+        readWriters.push_back(&getReadWriter(field.type));
+
+    // hasNext advances the CSV reader, so it must not be called for an entry that isn't loaded
+    std::size_t loaded = 0;
+    while (loaded < maxRows && reader.hasNext())
+    {
+        for (std::size_t i = 0; i < fields.size(); i++)
+        {
+            AllocationField scope(fields[i].type);
+            readWriters[i]->append(reader, columns[i], arena.get());
+        }
+        loaded++;
+    }
+
+    rowCount += loaded;
+    return loaded;
+}
+
+void Table::store(Writer& writer) const
+{
+    writer.startFile(getStructure());
+    storeRows(writer);
+    writer.finishFile();
+}
+
+void Table::storeRows(Writer& writer) const
+{
+    auto& fields = structure.getFields();
+
+    std::vector<ReadWriter*> readWriters;
+    for (auto& field : fields)
+        readWriters.push_back(&getReadWriter(field.type));
+
+    for (std::size_t row = 0; row < rowCount; row++)
+    {
+        writer.startEntry();
+        for (std::size_t i = 0; i < fields.size(); i++)
+        {
+            AllocationField scope(fields[i].type);
+            readWriters[i]->write(fields[i].name, columns[i], row, writer);
+        }
+        writer.finishEntry();
+    }
+}
+
+void Table::clear()
+{
+    for (auto& column : columns)
+        std::visit([](auto& values) { values.clear(); }, column);
+
+    rowCount = 0;
+    arena->release();
+}
+
+void Table::filterRows(const std::vector<uint8_t>& isKept)
+{
+    if (isKept.size() != rowCount) throw std::runtime_error("Row filter doesn't match the table.");
+
+    for (auto& column : columns)
+    {
+        auto compact = [&](auto& values)
+        {
+            std::size_t kept = 0;
+            for (std::size_t row = 0; row < rowCount; row++)
+                if (isKept[row]) values[kept++] = values[row];
+            values.resize(kept);
+        };
+        std::visit(compact, column);
+    }
+
+    rowCount -= std::count(isKept.begin(), isKept.end(), uint8_t(0));
+}
+
+boost::json::object Table::getStructure() const
+{
+    boost::json::object object;
+    for (auto& field : structure.getFields())
+        object[field.name] = field.typeName;
+
+    return object;
+}
+
+const Structure& Table::getLayout() const { return structure; }
+std::size_t Table::getRowCount() const { return rowCount; }
+
+std::size_t Table::getColumnIndex(std::string_view name) const
+{
+    auto& fields = structure.getFields();
+    auto it      = std::find_if(fields.begin(), fields.end(), [&](auto& field) { return field.name == name; });
+    if (it == fields.end()) throw std::runtime_error("Unknown field: " + std::string(name));
+
+    return it - fields.begin();
+}
+
+Column& Table::getColumn(std::size_t index) { return columns[index]; }
+const Column& Table::getColumn(std::size_t index) const { return columns[index]; }
+
+std::pmr::memory_resource* Table::getArena() { return arena.get(); }
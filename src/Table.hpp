@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Structure.hpp"
+#include "Value.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+/*
+ * A whole file in memory, stored as one contiguous vector per field instead of one object per entry, so passes over a
+ * few fields only touch the memory of those. Strings and arrays of all entries are views into a single arena owned by
+ * the table, which gets released as a whole together with it.
+ */
+class Table
+{
+    Structure structure;
+    std::vector<Column> columns{};
+    std::size_t rowCount = 0;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena; // keeps the views valid when the table is moved
+
+public:
+    Table(const Structure& structure);
+
+    // appends up to maxRows of the remaining entries of the reader, returns how many
+    std::size_t load(Reader& reader, std::size_t maxRows = SIZE_MAX);
+    // writes the whole file, including startFile and finishFile
+    void store(Writer& writer) const;
+    // writes the entries only
+    void storeRows(Writer& writer) const;
+    // removes every entry and releases the arena, the columns keep their capacity
+    void clear();
+    // removes every entry without a flag set, keeping the order of the others
+    void filterRows(const std::vector<uint8_t>& isKept);
+
+    boost::json::object getStructure() const;
+    const Structure& getLayout() const;
+    std::size_t getRowCount() const;
+
+    // throws for unknown fields
+    std::size_t getColumnIndex(std::string_view name) const;
+    Column& getColumn(std::size_t index);
+    const Column& getColumn(std::size_t index) const;
+
+    // memory for strings and arrays assigned to the table, lives as long as the table
+    std::pmr::memory_resource* getArena();
+};
@@ -0,0 +1,118 @@
+#include "Trace.hpp"
+
+#include <boost/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char* name;
+        std::string detail;
+        int64_t start;
+        int64_t duration;
+    };
+
+    struct ThreadTrace
+    {
+        uint32_t threadId;
+        std::vector<TraceEvent> events{};
+        ThreadTrace* next = nullptr;
+    };
+
+    std::atomic<bool> isTracing{ false };
+    std::atomic<ThreadTrace*> threadTraces{ nullptr };
+    std::atomic<uint32_t> nextThreadId{ 1 };
+    std::chrono::steady_clock::time_point traceStart;
+
+    int64_t getTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceStart)
+            .count();
+    }
+
+    // buffers are only ever added and live until the process exits, so they can be written after their thread is gone
+    ThreadTrace& getThreadTrace()
+    {
+        thread_local ThreadTrace* trace = nullptr;
+        if (trace) return *trace;
+
+        trace       = new ThreadTrace{ nextThreadId.fetch_add(1, std::memory_order_relaxed) };
+        trace->next = threadTraces.load(std::memory_order_relaxed);
+        while (!threadTraces.compare_exchange_weak(trace->next, trace, std::memory_order_release))
+            ;
+
+        return *trace;
+    }
+
+    // Chrome traces are in microseconds
+    double toMicroseconds(int64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; }
+} // namespace
+
+void startTrace()
+{
+    traceStart = std::chrono::steady_clock::now();
+    getThreadTrace(); // the calling thread gets the first ID
+    isTracing.store(true, std::memory_order_release);
+}
+
+void writeTrace(const std::string& path)
+{
+    isTracing.store(false, std::memory_order_release);
+
+    boost::json::array events;
+    for (auto trace = threadTraces.load(std::memory_order_acquire); trace; trace = trace->next)
+    {
+        boost::json::object threadName;
+        threadName["name"] = "thread_name";
+        threadName["ph"]   = "M";
+        threadName["pid"]  = 1;
+        threadName["tid"]  = trace->threadId;
+        auto name          = trace->threadId == 1 ? "main" : "worker " + std::to_string(trace->threadId);
+        threadName["args"] = boost::json::object{ { "name", name } };
+        events.push_back(std::move(threadName));
+
+        for (auto& event : trace->events)
+        {
+            boost::json::object span;
+            span["name"] = event.name;
+            span["ph"]   = "X";
+            span["ts"]   = toMicroseconds(event.start);
+            span["dur"]  = toMicroseconds(event.duration);
+            span["pid"]  = 1;
+            span["tid"]  = trace->threadId;
+            if (!event.detail.empty()) span["args"] = boost::json::object{ { "detail", event.detail } };
+            events.push_back(std::move(span));
+        }
+    }
+
+    std::ofstream file(path);
+    file << boost::json::object{ { "traceEvents", std::move(events) }, { "displayTimeUnit", "ms" } };
+    if (!file) throw std::runtime_error("Could not write trace: " + path);
+}
+
+/* Trace Span */
+TraceSpan::TraceSpan(const char* name)
+    : name(name)
+{
+    if (isTracing.load(std::memory_order_relaxed)) start = getTime();
+}
+
+TraceSpan::TraceSpan(const char* name, std::string detail)
+    : name(name)
+    , detail(std::move(detail))
+{
+    if (isTracing.load(std::memory_order_relaxed)) start = getTime();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (start < 0 || !isTracing.load(std::memory_order_relaxed)) return;
+
+    getThreadTrace().events.push_back({ name, std::move(detail), start, getTime() - start });
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// entries per span of an entry loop, small enough to show stalls while keeping the trace small
+constexpr std::size_t TRACE_CHUNK_SIZE = 16384;
+
+/*
+ * Records scoped spans in the Chrome trace event format, which can be opened in Perfetto or chrome://tracing.
+ * Every thread appends to its own buffer without any locking, so a span costs two clock reads while tracing and a
+ * single branch otherwise.
+ */
+void startTrace();
+
+// must only be called once all threads that recorded spans are done
+void writeTrace(const std::string& path);
+
+class TraceSpan
+{
+    const char* name;
+    std::string detail;
+    int64_t start = -1;
+
+public:
+    TraceSpan(const char* name);
+    TraceSpan(const char* name, std::string detail);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&)            = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
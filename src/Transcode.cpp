@@ -0,0 +1,601 @@
+#include "Transcode.hpp"
+
+#include "CompressedStream.hpp"
+#include "FileStream.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    // converts count kernel units from in to out
+    using Kernel = void (*)(const char* in, char* out, std::size_t count);
+
+    template<ByteOrder order> using ByteOrderConstant    = std::integral_constant<ByteOrder, order>;
+    template<Int24Encoding encoding> using Int24Constant = std::integral_constant<Int24Encoding, encoding>;
+
+    // calls select with the runtime value as a compile time constant
+    template<typename Select> auto withByteOrder(ByteOrder order, Select select)
+    {
+        if (order == ByteOrder::LITTLE) return select(ByteOrderConstant<ByteOrder::LITTLE>{});
+        return select(ByteOrderConstant<ByteOrder::BIG>{});
+    }
+
+    template<typename Select> auto withInt24Encoding(Int24Encoding encoding, Select select)
+    {
+        if (encoding == Int24Encoding::TWOS_COMPLEMENT) return select(Int24Constant<Int24Encoding::TWOS_COMPLEMENT>{});
+        return select(Int24Constant<Int24Encoding::SIGN_MAGNITUDE>{});
+    }
+
+    /* Kernels */
+    // the unit of copies is a byte, so adjacent fields of any type merge into one copy
+    void copyBytes(const char* in, char* out, std::size_t count) { std::memcpy(out, in, count); }
+
+    template<typename T> void swapValues(const char* in, char* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            T value;
+            std::memcpy(&value, in + i * sizeof(T), sizeof(T));
+            value = byteswap(value);
+            std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+        }
+    }
+
+    void reverse24(const char* in, char* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count * 3; i += 3)
+        {
+            out[i]     = in[i + 2];
+            out[i + 1] = in[i + 1];
+            out[i + 2] = in[i];
+        }
+    }
+
+    template<ByteOrder inOrder, Int24Encoding inEncoding, ByteOrder outOrder, Int24Encoding outEncoding>
+    void convertInt24(const char* in, char* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count * 3; i += 3)
+            storeInt24<outOrder, outEncoding>(loadInt24<inOrder, inEncoding>(in + i), out + i);
+    }
+
+    template<ByteOrder inOrder, ByteOrder outOrder, typename T>
+    void decimalToIeee(const char* in, char* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto value = static_cast<T>(decodeDecimal24(loadUInt24<inOrder>(in + i * 3)));
+            storeValue<outOrder>(value, out + i * sizeof(T));
+        }
+    }
+
+    template<ByteOrder inOrder, ByteOrder outOrder, typename T>
+    void ieeeToDecimal(const char* in, char* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto value = static_cast<float>(loadValue<inOrder, T>(in + i * sizeof(T)));
+            storeUInt24<outOrder>(encodeDecimal24(value), out + i * 3);
+        }
+    }
+
+    template<ByteOrder order, Int24Encoding encoding> int64_t loadLength24(const char* bytes)
+    {
+        return loadInt24<order, encoding>(bytes);
+    }
+
+    template<ByteOrder order> int64_t loadLength32(const char* bytes) { return loadValue<order, int32_t>(bytes); }
+
+    /* Codecs */
+    struct Codec
+    {
+        Kernel kernel;
+        std::size_t inSize;    // of one kernel unit
+        std::size_t outSize;   // of one kernel unit
+        std::size_t units = 1; // kernel units per value
+    };
+
+    // the same value in both formats, either as is or byte swapped
+    Codec getSwapCodec(std::size_t size, bool isSwapped)
+    {
+        if (!isSwapped || size == 1) return { copyBytes, 1, 1, size };
+        if (size == 2) return { swapValues<uint16_t>, 2, 2 };
+        if (size == 3) return { reverse24, 3, 3 };
+        if (size == 4) return { swapValues<uint32_t>, 4, 4 };
+
+        return { swapValues<uint64_t>, 8, 8 };
+    }
+
+    Codec getInt24Codec(const BinaryFormat& in, const BinaryFormat& out)
+    {
+        if (in.int24Encoding == out.int24Encoding) return getSwapCodec(3, in.byteOrder != out.byteOrder);
+
+        auto select = [&](auto inOrder, auto inEncoding)
+        {
+            return withByteOrder(out.byteOrder,
+                                 [&](auto outOrder)
+                                 {
+                                     return withInt24Encoding(out.int24Encoding,
+                                                              [&](auto outEncoding) -> Kernel
+                                                              {
+                                                                  return convertInt24<decltype(inOrder)::value,
+                                                                                      decltype(inEncoding)::value,
+                                                                                      decltype(outOrder)::value,
+                                                                                      decltype(outEncoding)::value>;
+                                                              });
+                                 });
+        };
+        auto kernel = withByteOrder(in.byteOrder,
+                                    [&](auto inOrder)
+                                    {
+                                        return withInt24Encoding(in.int24Encoding,
+                                                                 [&](auto inEncoding)
+                                                                 { return select(inOrder, inEncoding); });
+                                    });
+
+        return { kernel, 3, 3 };
+    }
+
+    template<typename T> Codec getFloatCodec(const BinaryFormat& in, const BinaryFormat& out)
+    {
+        bool isDecimal = in.floatEncoding == FloatEncoding::DECIMAL24;
+        bool isSwapped = in.byteOrder != out.byteOrder;
+        if (in.floatEncoding == out.floatEncoding) return getSwapCodec(isDecimal ? 3 : sizeof(T), isSwapped);
+
+        auto kernel = withByteOrder(in.byteOrder,
+                                    [&](auto inOrder)
+                                    {
+                                        return withByteOrder(out.byteOrder,
+                                                             [&](auto outOrder) -> Kernel
+                                                             {
+                                                                 constexpr auto inValue  = decltype(inOrder)::value;
+                                                                 constexpr auto outValue = decltype(outOrder)::value;
+                                                                 if (isDecimal)
+                                                                     return decimalToIeee<inValue, outValue, T>;
+                                                                 return ieeeToDecimal<inValue, outValue, T>;
+                                                             });
+                                    });
+
+        return isDecimal ? Codec{ kernel, 3, sizeof(T) } : Codec{ kernel, sizeof(T), 3 };
+    }
+
+    // codec of a value or of the elements of an array
+    Codec getValueCodec(FieldType type, const BinaryFormat& in, const BinaryFormat& out)
+    {
+        bool isSwapped = in.byteOrder != out.byteOrder;
+
+        switch (type)
+        {
+            case FieldType::INT24:
+            case FieldType::INT24ARRAY: return getInt24Codec(in, out);
+            case FieldType::UINT24:
+            case FieldType::UINT24ARRAY: return getSwapCodec(3, isSwapped);
+            case FieldType::INT32ARRAY:
+            case FieldType::UINT32ARRAY: return getSwapCodec(4, isSwapped);
+            case FieldType::FLOAT:
+            case FieldType::FLOATARRAY: return getFloatCodec<float>(in, out);
+            case FieldType::DOUBLE:
+            case FieldType::DOUBLEARRAY: return getFloatCodec<double>(in, out);
+            case FieldType::STRING: return getSwapCodec(2, isSwapped); // indices into the string table
+            default: return getSwapCodec(getEncodedSize(in, type), isSwapped);
+        }
+    }
+
+    /* Steps */
+    enum class StepKind
+    {
+        FIXED,  // a run of fields converted by the same kernel
+        STRING, // moved between the string table and inline storage
+        ARRAY,  // length, followed by the elements
+    };
+
+    struct Step
+    {
+        StepKind kind;
+        Codec codec{};         // of the fixed fields or the array elements
+        std::size_t count = 0; // kernel units of the fixed fields
+        Codec length{};        // of arrays
+        int64_t (*loadLength)(const char*) = nullptr;
+    };
+
+    std::vector<Step> compileSteps(const Structure& structure, const BinaryFormat& in, const BinaryFormat& out)
+    {
+        bool isTable = in.stringEncoding == StringEncoding::TABLE && out.stringEncoding == StringEncoding::TABLE;
+
+        std::vector<Step> steps;
+        for (auto& field : structure.getFields())
+        {
+            auto type = field.type;
+            if (type == FieldType::STRING && !isTable)
+            {
+                steps.push_back({ StepKind::STRING });
+                continue;
+            }
+
+            auto codec = getValueCodec(type, in, out);
+            if (type >= FieldType::INT24ARRAY)
+            {
+                // arrays of int24 store their length as int24 as well
+                bool isInt24 = type == FieldType::INT24ARRAY || type == FieldType::UINT24ARRAY;
+                Step step{ StepKind::ARRAY, codec };
+                step.length     = isInt24 ? getInt24Codec(in, out) : getSwapCodec(4, in.byteOrder != out.byteOrder);
+                step.loadLength = withByteOrder(in.byteOrder,
+                                                [&](auto order)
+                                                {
+                                                    constexpr auto orderValue = decltype(order)::value;
+                                                    if (!isInt24) return loadLength32<orderValue>;
+                                                    if (in.int24Encoding == Int24Encoding::SIGN_MAGNITUDE)
+                                                        return loadLength24<orderValue, Int24Encoding::SIGN_MAGNITUDE>;
+                                                    return loadLength24<orderValue, Int24Encoding::TWOS_COMPLEMENT>;
+                                                });
+                steps.push_back(step);
+                continue;
+            }
+
+            if (!steps.empty() && steps.back().kind == StepKind::FIXED && steps.back().codec.kernel == codec.kernel)
+                steps.back().count += codec.units;
+            else
+                steps.push_back({ StepKind::FIXED, codec, codec.units });
+        }
+
+        return steps;
+    }
+
+    /* Blocks */
+    class BlockInput
+    {
+        std::streambuf* buffer;
+        std::vector<char> block;
+        std::size_t position = 0;
+        std::size_t end      = 0;
+        bool isEnd           = false;
+
+        // makes at least size bytes available, false when the file ends before
+        bool fill(std::size_t size)
+        {
+            if (end - position >= size) return true;
+
+            std::memmove(block.data(), block.data() + position, end - position);
+            end -= position;
+            position = 0;
+            if (block.size() < size) block.resize(std::max(size, block.size() * 2));
+
+            while (end < size && !isEnd)
+            {
+                auto count = buffer->sgetn(block.data() + end, static_cast<std::streamsize>(block.size() - end));
+                if (count <= 0)
+                    isEnd = true;
+                else
+                    end += count;
+            }
+
+            return end - position >= size;
+        }
+
+    public:
+        BlockInput(std::streambuf* buffer)
+            : buffer(buffer)
+            , block(TRANSCODE_BLOCK_SIZE)
+        {
+        }
+
+        bool hasNext() { return fill(1); }
+        std::size_t getAvailable() const { return end - position; }
+
+        const char* require(std::size_t size)
+        {
+            if (!fill(size)) throw std::runtime_error("Unexpected end of file.");
+            return block.data() + position;
+        }
+
+        void consume(std::size_t size) { position += size; }
+
+        // consumes a null-terminated string, the view is valid until the next call
+        std::string_view readString()
+        {
+            std::size_t searched = 0;
+            while (true)
+            {
+                auto start = block.data() + position;
+                auto found = std::memchr(start + searched, '\0', end - position - searched);
+                if (found)
+                {
+                    std::size_t size = static_cast<const char*>(found) - start;
+                    position += size + 1;
+                    return { start, size };
+                }
+
+                searched = end - position;
+                require(searched + 1);
+            }
+        }
+    };
+
+    class BlockOutput
+    {
+        std::streambuf* buffer;
+        std::vector<char> block;
+        std::size_t end = 0;
+
+    public:
+        BlockOutput(std::streambuf* buffer)
+            : buffer(buffer)
+            , block(TRANSCODE_BLOCK_SIZE)
+        {
+        }
+
+        char* reserve(std::size_t size)
+        {
+            if (block.size() - end < size)
+            {
+                flush();
+                if (block.size() < size) block.resize(size);
+            }
+
+            return block.data() + end;
+        }
+
+        void commit(std::size_t size) { end += size; }
+
+        void flush()
+        {
+            auto count = static_cast<std::streamsize>(end);
+            if (buffer->sputn(block.data(), count) != count) throw std::runtime_error("Could not write file.");
+            end = 0;
+        }
+    };
+
+    /* Transcoder */
+    class Transcoder
+    {
+        const std::vector<Step>& steps;
+        const BinaryFormat& inFormat;
+        const BinaryFormat& outFormat;
+        const std::vector<std::string>& inStrings;
+        std::vector<std::string>& outStrings;
+        BlockInput& input;
+        BlockOutput& output;
+
+        void convert(const Codec& codec, std::size_t count)
+        {
+            // huge arrays go through in pieces
+            auto piece = std::max<std::size_t>(1, TRANSCODE_BLOCK_SIZE / std::max(codec.inSize, codec.outSize));
+            for (std::size_t first = 0; first < count; first += piece)
+            {
+                auto size = std::min(piece, count - first);
+                codec.kernel(input.require(size * codec.inSize), output.reserve(size * codec.outSize), size);
+                input.consume(size * codec.inSize);
+                output.commit(size * codec.outSize);
+            }
+        }
+
+        void convertString()
+        {
+            std::string_view value;
+            if (inFormat.stringEncoding == StringEncoding::TABLE)
+            {
+                auto bytes = input.require(2);
+                auto index = inFormat.byteOrder == ByteOrder::LITTLE ? loadValue<ByteOrder::LITTLE, uint16_t>(bytes)
+                                                                     : loadValue<ByteOrder::BIG, uint16_t>(bytes);
+                if (index >= inStrings.size())
+                    throw std::runtime_error("String index " + std::to_string(index) +
+                                             " is out of range, the table has " + std::to_string(inStrings.size()) +
+                                             " strings.");
+
+                input.consume(2);
+                value = inStrings[index];
+            }
+            else
+                value = input.readString();
+
+            if (outFormat.stringEncoding == StringEncoding::TABLE)
+            {
+                if (outStrings.size() > std::numeric_limits<uint16_t>::max())
+                    throw std::runtime_error("The string table is full, it can only hold 65536 strings.");
+
+                auto index = static_cast<uint16_t>(outStrings.size());
+                if (outFormat.byteOrder == ByteOrder::LITTLE)
+                    storeValue<ByteOrder::LITTLE>(index, output.reserve(2));
+                else
+                    storeValue<ByteOrder::BIG>(index, output.reserve(2));
+                output.commit(2);
+                outStrings.emplace_back(value);
+            }
+            else
+            {
+                auto bytes = output.reserve(value.size() + 1);
+                std::memcpy(bytes, value.data(), value.size());
+                bytes[value.size()] = '\0';
+                output.commit(value.size() + 1);
+            }
+        }
+
+        void convertArray(const Step& step)
+        {
+            auto length = step.loadLength(input.require(step.length.inSize));
+            if (length < 0) throw std::runtime_error("Invalid array length: " + std::to_string(length));
+
+            convert(step.length, step.length.units);
+            convert(step.codec, static_cast<std::size_t>(length) * step.codec.units);
+        }
+
+    public:
+        Transcoder(const std::vector<Step>& steps,
+                   const BinaryFormat& inFormat,
+                   const BinaryFormat& outFormat,
+                   const std::vector<std::string>& inStrings,
+                   std::vector<std::string>& outStrings,
+                   BlockInput& input,
+                   BlockOutput& output)
+            : steps(steps)
+            , inFormat(inFormat)
+            , outFormat(outFormat)
+            , inStrings(inStrings)
+            , outStrings(outStrings)
+            , input(input)
+            , output(output)
+        {
+        }
+
+        void convertEntry()
+        {
+            for (auto& step : steps)
+            {
+                switch (step.kind)
+                {
+                    case StepKind::FIXED: convert(step.codec, step.count); break;
+                    case StepKind::STRING: convertString(); break;
+                    case StepKind::ARRAY: convertArray(step); break;
+                }
+            }
+        }
+
+        // entries of fixed size, all of them in the input block
+        void convertEntries(std::size_t count, std::size_t inEntrySize, std::size_t outEntrySize)
+        {
+            auto in  = input.require(count * inEntrySize);
+            auto out = output.reserve(count * outEntrySize);
+
+            // a single run continues across entries
+            if (steps.size() == 1)
+                steps[0].codec.kernel(in, out, count * steps[0].count);
+            else
+            {
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    for (auto& step : steps)
+                    {
+                        step.codec.kernel(in, out, step.count);
+                        in += step.count * step.codec.inSize;
+                        out += step.count * step.codec.outSize;
+                    }
+                }
+            }
+
+            input.consume(count * inEntrySize);
+            output.commit(count * outEntrySize);
+        }
+    };
+
+    uint64_t getNumber(const boost::json::object& config, const char* key)
+    {
+        auto value = config.if_contains(key);
+        return value && !value->is_null() ? value->to_number<uint64_t>() : 0;
+    }
+
+    std::string getText(const boost::json::object& config, const char* key)
+    {
+        auto value = config.if_contains(key);
+        return value && value->is_string() ? std::string(value->as_string()) : "";
+    }
+} // namespace
+
+void transcodeBinary(const Structure& structure,
+                     const BinaryFormat& inFormat,
+                     const boost::json::object& inConfig,
+                     const BinaryFormat& outFormat,
+                     boost::json::object outConfig)
+{
+    TraceSpan span("transcode");
+
+    std::string inPath(inConfig.at("path").as_string());
+    std::string outPath(outConfig.at("path").as_string());
+    auto inTextPath  = getText(inConfig, "textPath");
+    auto outTextPath = getText(outConfig, "textPath");
+    auto inOffset    = getNumber(inConfig, "offset");
+    auto outOffset   = getNumber(outConfig, "offset");
+    auto entryCount  = getNumber(inConfig, "entryCount");
+
+    if (structure.getFieldCount() == 0) throw std::runtime_error("The structure has no fields.");
+
+    auto steps   = compileSteps(structure, inFormat, outFormat);
+    bool isFixed = std::all_of(steps.begin(), steps.end(), [](auto& step) { return step.kind == StepKind::FIXED; });
+
+    std::size_t inEntrySize  = 0;
+    std::size_t outEntrySize = 0;
+    for (auto& step : steps)
+    {
+        inEntrySize += step.count * step.codec.inSize;
+        outEntrySize += step.count * step.codec.outSize;
+    }
+
+    // input
+    if (!inputExists(inConfig, inPath)) throw std::runtime_error("Input file does not exist!");
+
+    auto inBuffer = openInputBuffer(inConfig, inPath, std::ios::binary);
+    if (inOffset != 0 && inBuffer->pubseekpos(inOffset, std::ios::in) < 0)
+        throw std::runtime_error("Could not seek to the offset of the input file.");
+
+    std::vector<std::string> inStrings;
+    if (inFormat.stringEncoding == StringEncoding::TABLE && !inTextPath.empty())
+        inStrings = loadStringTable(inConfig, inTextPath);
+
+    // indices are copied as they are, so the whole table carries over, without the empty string after the last comma
+    std::vector<std::string> outStrings;
+    if (inFormat.stringEncoding == StringEncoding::TABLE && outFormat.stringEncoding == StringEncoding::TABLE)
+    {
+        outStrings = inStrings;
+        if (!outStrings.empty() && outStrings.back().empty()) outStrings.pop_back();
+    }
+
+    // output, preallocated exactly for entries of fixed size and from the size of the input otherwise
+    uint64_t inSize = 0;
+    if (!inConfig.if_contains("bundle") && getCompression(inConfig, inPath) == Compression::NONE &&
+        std::filesystem::is_regular_file(inPath))
+        inSize = std::filesystem::file_size(inPath) - std::min<uint64_t>(inOffset, std::filesystem::file_size(inPath));
+
+    if (inSize != 0)
+    {
+        uint64_t entries = isFixed ? inSize / inEntrySize : 0;
+        if (entryCount != 0) entries = std::min(entries, entryCount);
+        outConfig["sizeHint"] = outOffset + (isFixed ? entries * outEntrySize : inSize);
+    }
+
+    OutputFile file(outConfig, outPath, std::ios::binary);
+    if (outOffset != 0 && file.get()->pubseekpos(outOffset, std::ios::out) < 0)
+        throw std::runtime_error("Could not seek to the offset of the output file.");
+
+    // convert
+    BlockInput input(inBuffer.get());
+    BlockOutput output(file.get());
+    Transcoder transcoder(steps, inFormat, outFormat, inStrings, outStrings, input, output);
+
+    std::optional<TraceSpan> chunkSpan;
+    std::size_t entry = 0;
+    while ((entryCount == 0 || entry < entryCount) && input.hasNext())
+    {
+        if (entry % TRACE_CHUNK_SIZE == 0) chunkSpan.emplace("entries", std::to_string(entry));
+
+        if (!isFixed)
+        {
+            transcoder.convertEntry();
+            entry++;
+            continue;
+        }
+
+        // as many entries at once as the input block holds, without crossing a trace chunk
+        input.require(inEntrySize);
+        auto count = std::min({ input.getAvailable() / inEntrySize,
+                                TRACE_CHUNK_SIZE - entry % TRACE_CHUNK_SIZE,
+                                std::max<std::size_t>(1, TRANSCODE_BLOCK_SIZE / outEntrySize) });
+        if (entryCount != 0) count = std::min<std::size_t>(count, entryCount - entry);
+
+        transcoder.convertEntries(count, inEntrySize, outEntrySize);
+        entry += count;
+    }
+    chunkSpan.reset();
+    output.flush();
+
+    std::unique_ptr<OutputFile> textFile;
+    if (!outTextPath.empty() && !outStrings.empty()) textFile = stageStringTable(outTextPath, outStrings);
+    file.commit();
+    if (textFile) textFile->commit();
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "BinaryChannel.hpp"
+#include "Structure.hpp"
+
+#include <boost/json.hpp>
+
+// bytes read and written at once
+constexpr std::size_t TRANSCODE_BLOCK_SIZE = 1024 * 1024;
+
+/*
+ * Converts a binary file into another binary format without decoding its entries into values. The structure gets
+ * compiled into a short list of kernels, each converting a run of adjacent fields in one loop: plain copies for fields
+ * both formats store alike, byte swaps, and conversions between the int24 and float encodings. Strings are moved
+ * between the string table and inline storage, arrays get their length converted before their elements.
+ * Fields stored alike in both formats are copied bit for bit, including values the channels would normalize.
+ * Takes the same channel configs as makeBinaryReader and makeBinaryWriter.
+ */
+void transcodeBinary(const Structure& structure,
+                     const BinaryFormat& inFormat,
+                     const boost::json::object& inConfig,
+                     const BinaryFormat& outFormat,
+                     boost::json::object outConfig);
@@ -0,0 +1,325 @@
+#include "Transform.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+    // the sign-magnitude encoding can't store -2^23
+    constexpr double INT24_MAX  = 8388607.0;
+    constexpr double UINT24_MAX = 16777215.0;
+
+    template<typename T> std::pair<double, double> getRange(FieldType type)
+    {
+        if (type == FieldType::INT24) return { -INT24_MAX, INT24_MAX };
+        if (type == FieldType::UINT24) return { 0.0, UINT24_MAX };
+
+        return { static_cast<double>(std::numeric_limits<T>::lowest()),
+                 static_cast<double>(std::numeric_limits<T>::max()) };
+    }
+
+    template<typename T>
+    void storeResults(std::vector<T>& values,
+                      const Field& field,
+                      std::size_t first,
+                      std::size_t count,
+                      const double* results,
+                      const std::vector<uint8_t>& isSelected)
+    {
+        auto [min, max] = getRange<T>(field.type);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (!isSelected.empty() && !isSelected[first + i]) continue;
+
+            // infinity and NaN can't be stored by every encoding, like DECIMAL24
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                auto value = static_cast<T>(results[i]);
+                if (!std::isfinite(value))
+                    throw std::runtime_error("Expression for " + field.name + " is not a finite number.");
+                values[first + i] = value;
+            }
+            else
+            {
+                if (std::isnan(results[i]))
+                    throw std::runtime_error("Expression for " + field.name + " is not a number.");
+                values[first + i] = static_cast<T>(std::clamp(std::round(results[i]), min, max));
+            }
+        }
+    }
+} // namespace
+
+/* Expression */
+// recursive descent, emitting the instructions of every operation after the ones of its operands
+class ExpressionParser
+{
+    using Operation = Expression::Operation;
+
+    const std::string& expression;
+    const Structure& structure;
+    Expression& target;
+    std::size_t position = 0;
+    std::size_t depth    = 0;
+
+    void skipSpaces()
+    {
+        while (position < expression.size() && std::isspace(static_cast<unsigned char>(expression[position])))
+            position++;
+    }
+
+    bool consume(char ch)
+    {
+        skipSpaces();
+        if (position >= expression.size() || expression[position] != ch) return false;
+
+        position++;
+        return true;
+    }
+
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error("Invalid expression at position " + std::to_string(position) + ": " + expression);
+    }
+
+    void emit(Operation operation, std::size_t field = 0, double value = 0.0)
+    {
+        target.program.push_back({ operation, field, value });
+
+        if (operation == Operation::FIELD || operation == Operation::CONSTANT)
+            target.stackSize = std::max(target.stackSize, ++depth);
+        else if (operation != Operation::NEGATE)
+            depth--;
+    }
+
+    void parseSum()
+    {
+        parseProduct();
+        while (true)
+        {
+            if (consume('+'))
+                parseProduct(), emit(Operation::ADD);
+            else if (consume('-'))
+                parseProduct(), emit(Operation::SUBTRACT);
+            else
+                return;
+        }
+    }
+
+    void parseProduct()
+    {
+        parseUnary();
+        while (true)
+        {
+            if (consume('*'))
+                parseUnary(), emit(Operation::MULTIPLY);
+            else if (consume('/'))
+                parseUnary(), emit(Operation::DIVIDE);
+            else
+                return;
+        }
+    }
+
+    void parseUnary()
+    {
+        if (consume('-'))
+            parseUnary(), emit(Operation::NEGATE);
+        else if (consume('+'))
+            parseUnary();
+        else
+            parsePrimary();
+    }
+
+    void parsePrimary()
+    {
+        if (consume('('))
+        {
+            parseSum();
+            if (!consume(')')) fail();
+            return;
+        }
+
+        skipSpaces();
+        if (position >= expression.size()) fail();
+
+        auto start = expression.c_str() + position;
+        if (std::isdigit(static_cast<unsigned char>(*start)) || *start == '.')
+        {
+            char* end;
+            emit(Operation::CONSTANT, 0, std::strtod(start, &end));
+            position += end - start;
+            return;
+        }
+
+        auto length = position;
+        while (length < expression.size() &&
+               (std::isalnum(static_cast<unsigned char>(expression[length])) || expression[length] == '_'))
+            length++;
+        length -= position;
+        if (length == 0) fail();
+
+        auto name  = expression.substr(position, length);
+        auto field = findField(structure, name);
+        if (!isNumeric(structure.getFields()[field].type))
+            throw std::runtime_error("Expressions are only supported on numeric fields: " + name);
+
+        emit(Operation::FIELD, field);
+        position += length;
+    }
+
+public:
+    ExpressionParser(const std::string& expression, const Structure& structure, Expression& target)
+        : expression(expression)
+        , structure(structure)
+        , target(target)
+    {
+        parseSum();
+        skipSpaces();
+        if (position != expression.size()) fail();
+    }
+};
+
+Expression::Expression(const std::string& expression, const Structure& structure)
+{
+    ExpressionParser parser(expression, structure, *this);
+}
+
+void Expression::evaluate(const Table& table, std::size_t first, std::size_t count, double* result) const
+{
+    thread_local std::vector<double> stack;
+    stack.resize(stackSize * EXPRESSION_BLOCK_SIZE);
+
+    std::size_t depth = 0;
+    auto push         = [&]() { return stack.data() + depth++ * EXPRESSION_BLOCK_SIZE; };
+
+    // the result replaces the left operand
+    auto combine = [&](auto operation)
+    {
+        depth--;
+        auto left  = stack.data() + (depth - 1) * EXPRESSION_BLOCK_SIZE;
+        auto right = left + EXPRESSION_BLOCK_SIZE;
+        for (std::size_t i = 0; i < count; i++)
+            left[i] = operation(left[i], right[i]);
+    };
+
+    for (auto& instruction : program)
+    {
+        switch (instruction.operation)
+        {
+            case Operation::FIELD:
+            {
+                auto target = push();
+                auto load   = [&](auto& values)
+                {
+                    using T = typename std::decay_t<decltype(values)>::value_type;
+                    if constexpr (std::is_arithmetic_v<T>)
+                        for (std::size_t i = 0; i < count; i++)
+                            target[i] = static_cast<double>(values[first + i]);
+                };
+                std::visit(load, table.getColumn(instruction.field));
+                break;
+            }
+            case Operation::CONSTANT: std::fill_n(push(), count, instruction.value); break;
+            case Operation::ADD: combine(std::plus<double>()); break;
+            case Operation::SUBTRACT: combine(std::minus<double>()); break;
+            case Operation::MULTIPLY: combine(std::multiplies<double>()); break;
+            case Operation::DIVIDE: combine(std::divides<double>()); break;
+            case Operation::NEGATE:
+            {
+                auto top = stack.data() + (depth - 1) * EXPRESSION_BLOCK_SIZE;
+                for (std::size_t i = 0; i < count; i++)
+                    top[i] = -top[i];
+                break;
+            }
+        }
+    }
+
+    std::copy_n(stack.data(), count, result);
+}
+
+/* Transform */
+Transform::Transform(const boost::json::object& spec, const Structure& structure)
+{
+    auto stepList = spec.if_contains("steps");
+    if (!stepList) throw std::runtime_error("Transform has no steps.");
+
+    for (auto& stepValue : stepList->as_array())
+    {
+        auto& stepConfig = stepValue.as_object();
+        auto& step       = steps.emplace_back();
+
+        if (auto where = stepConfig.if_contains("where"))
+            step.where.emplace(std::string(where->as_string()), structure);
+        if (auto filter = stepConfig.if_contains("filter"))
+            step.filter.emplace(std::string(filter->as_string()), structure);
+
+        if (auto set = stepConfig.if_contains("set"))
+        {
+            for (auto& entry : set->as_object())
+            {
+                std::string name(entry.key());
+                auto field = findField(structure, name);
+                if (!isNumeric(structure.getFields()[field].type))
+                    throw std::runtime_error("Only numeric fields can be set: " + name);
+
+                step.assignments.push_back({ field, Expression(std::string(entry.value().as_string()), structure) });
+            }
+        }
+
+        if (step.assignments.empty() && !step.filter)
+            throw std::runtime_error("Every transform step needs a \"set\" or a \"filter\".");
+        if (step.assignments.empty() && step.where)
+            throw std::runtime_error("\"where\" only selects entries for a \"set\", \"filter\" removes entries.");
+    }
+}
+
+void Transform::apply(Table& table) const
+{
+    auto& fields = table.getLayout().getFields();
+    std::vector<double> results;
+
+    for (auto& step : steps)
+    {
+        if (!step.assignments.empty())
+        {
+            auto isSelected = step.where ? step.where->evaluate(table) : std::vector<uint8_t>{};
+            results.resize(step.assignments.size() * EXPRESSION_BLOCK_SIZE);
+
+            // all expressions of a block are evaluated before any of them gets stored
+            for (std::size_t first = 0; first < table.getRowCount(); first += EXPRESSION_BLOCK_SIZE)
+            {
+                auto count = std::min(EXPRESSION_BLOCK_SIZE, table.getRowCount() - first);
+                for (std::size_t i = 0; i < step.assignments.size(); i++)
+                    step.assignments[i].expression.evaluate(table,
+                                                            first,
+                                                            count,
+                                                            results.data() + i * EXPRESSION_BLOCK_SIZE);
+
+                for (std::size_t i = 0; i < step.assignments.size(); i++)
+                {
+                    auto& field = fields[step.assignments[i].field];
+                    auto store  = [&](auto& values)
+                    {
+                        using T = typename std::decay_t<decltype(values)>::value_type;
+                        if constexpr (std::is_arithmetic_v<T>)
+                            storeResults(values,
+                                         field,
+                                         first,
+                                         count,
+                                         results.data() + i * EXPRESSION_BLOCK_SIZE,
+                                         isSelected);
+                    };
+                    std::visit(store, table.getColumn(step.assignments[i].field));
+                }
+            }
+        }
+
+        if (step.filter) table.filterRows(step.filter->evaluate(table));
+    }
+}
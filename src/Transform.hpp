@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Query.hpp"
+#include "Structure.hpp"
+#include "Table.hpp"
+
+#include <boost/json.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// entries evaluated at once, small enough for the intermediate results to stay in the cache
+constexpr std::size_t EXPRESSION_BLOCK_SIZE = 1024;
+
+/*
+ * Arithmetic on numeric fields and numbers, e.g. "atkMax * 1.1 + 5". Supports +, -, * and / with the usual
+ * precedence, unary minus and parentheses. Compiled into a postfix program that runs a block of entries per
+ * instruction, so every instruction is a simple loop over doubles.
+ */
+class Expression
+{
+    enum class Operation
+    {
+        FIELD,
+        CONSTANT,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        NEGATE,
+    };
+
+    struct Instruction
+    {
+        Operation operation;
+        std::size_t field = 0;
+        double value      = 0.0;
+    };
+
+    std::vector<Instruction> program{};
+    std::size_t stackSize = 0;
+
+    friend class ExpressionParser;
+
+public:
+    Expression(const std::string& expression, const Structure& structure);
+
+    // evaluates the entries [first, first + count) into result, count must not exceed EXPRESSION_BLOCK_SIZE
+    void evaluate(const Table& table, std::size_t first, std::size_t count, double* result) const;
+};
+
+/*
+ * A balance patch, applied to a whole table in memory. The spec is a list of steps, applied in order:
+ *   { "steps": [ { "where": "groupId == 3", "set": { "hpMax": "hpMax * 1.1" } }, { "filter": "hpMax > 0" } ] }
+ * "set" assigns the results of expressions to numeric fields, only for entries matching the optional "where".
+ * All expressions of a step see the values from before it. "filter" removes all entries not matching the condition.
+ * Integers are rounded to the nearest value and clamped to the range of their type.
+ */
+class Transform
+{
+    struct Assignment
+    {
+        std::size_t field;
+        Expression expression;
+    };
+
+    struct Step
+    {
+        std::optional<Predicate> where{};
+        std::vector<Assignment> assignments{};
+        std::optional<Predicate> filter{};
+    };
+
+    std::vector<Step> steps{};
+
+public:
+    Transform(const boost::json::object& spec, const Structure& structure);
+
+    void apply(Table& table) const;
+};
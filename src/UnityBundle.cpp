@@ -0,0 +1,480 @@
+#include "UnityBundle.hpp"
+
+#include "ByteOrder.hpp"
+
+#ifdef BDC_LZMA
+    #include <lzma.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint32_t COMPRESSION_MASK            = 0x3F;
+    constexpr uint32_t BLOCKS_INFO_AT_END          = 0x80;
+    constexpr uint32_t BLOCKS_INFO_NEEDS_PADDING   = 0x200;
+    constexpr uint32_t NODE_IS_SERIALIZED_FILE     = 0x4;
+    constexpr int32_t MONO_BEHAVIOUR_CLASS_ID      = 114;
+    constexpr int32_t TEXT_ASSET_CLASS_ID          = 49;
+    constexpr std::size_t SERIALIZED_HEADER_SIZE   = 20;
+    constexpr std::size_t SERIALIZED_HEADER_SIZE22 = 48; // format 22 adds 64 bit sizes and offsets
+    constexpr std::size_t LZMA_PROPS_SIZE          = 5;  // Unity stores the raw LZMA1 properties before the stream
+
+    enum class BlockCompression
+    {
+        NONE  = 0,
+        LZMA  = 1,
+        LZ4   = 2,
+        LZ4HC = 3,
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    template<typename T> T readBigEndian(std::istream& stream)
+    {
+        char bytes[sizeof(T)];
+        if (!stream.read(bytes, sizeof(T))) throw std::runtime_error("Unexpected end of bundle.");
+        return loadValue<ByteOrder::BIG, T>(bytes);
+    }
+
+    std::string readCString(std::istream& stream)
+    {
+        std::string value;
+        if (!std::getline(stream, value, '\0')) throw std::runtime_error("Unexpected end of bundle.");
+        return value;
+    }
+
+    // bounds checked cursor over decompressed data, in the byte order of the serialized file
+    class ByteCursor
+    {
+        const char* data;
+        std::size_t size;
+        std::size_t position = 0;
+        bool isBigEndian;
+
+        void require(std::size_t count)
+        {
+            if (count > size - position) throw std::runtime_error("Corrupt serialized file in bundle.");
+        }
+
+    public:
+        ByteCursor(const char* data, std::size_t size, bool isBigEndian)
+            : data(data)
+            , size(size)
+            , isBigEndian(isBigEndian)
+        {
+        }
+
+        template<typename T> T read()
+        {
+            require(sizeof(T));
+            auto bytes = data + position;
+            position += sizeof(T);
+            return isBigEndian ? loadValue<ByteOrder::BIG, T>(bytes) : loadValue<ByteOrder::LITTLE, T>(bytes);
+        }
+
+        std::string_view readBytes(std::size_t count)
+        {
+            require(count);
+            std::string_view value(data + position, count);
+            position += count;
+            return value;
+        }
+
+        std::string_view readCString()
+        {
+            auto end = static_cast<const char*>(std::memchr(data + position, '\0', size - position));
+            if (!end) throw std::runtime_error("Corrupt serialized file in bundle.");
+
+            auto value = readBytes(end - (data + position));
+            position++;
+            return value;
+        }
+
+        void skip(std::size_t count)
+        {
+            require(count);
+            position += count;
+        }
+
+        // alignment is relative to the start of the data
+        void align(std::size_t alignment) { skip(alignUp(position, alignment) - position); }
+
+        std::size_t getPosition() const { return position; }
+    };
+
+    void decompressLz4(const char* source, std::size_t sourceSize, char* target, std::size_t targetSize)
+    {
+        auto input     = reinterpret_cast<const uint8_t*>(source);
+        auto inputEnd  = input + sourceSize;
+        auto output    = target;
+        auto outputEnd = target + targetSize;
+
+        auto fail = []() { throw std::runtime_error("Corrupt LZ4 block in bundle."); };
+
+        // lengths of 15 continue in the following bytes, until one is less than 255
+        auto readLength = [&](std::size_t length)
+        {
+            if (length != 15) return length;
+
+            uint8_t value;
+            do
+            {
+                if (input == inputEnd) fail();
+                value = *input++;
+                length += value;
+            } while (value == 255);
+
+            return length;
+        };
+
+        while (input < inputEnd)
+        {
+            auto token         = *input++;
+            auto literalLength = readLength(token >> 4);
+            if (literalLength > static_cast<std::size_t>(inputEnd - input) ||
+                literalLength > static_cast<std::size_t>(outputEnd - output))
+                fail();
+
+            std::memcpy(output, input, literalLength);
+            input += literalLength;
+            output += literalLength;
+
+            // the last sequence only has literals
+            if (input == inputEnd) break;
+            if (inputEnd - input < 2) fail();
+
+            std::size_t offset = input[0] | (input[1] << 8);
+            input += 2;
+            auto matchLength = readLength(token & 0x0F) + 4;
+            if (offset == 0 || offset > static_cast<std::size_t>(output - target) ||
+                matchLength > static_cast<std::size_t>(outputEnd - output))
+                fail();
+
+            // matches may overlap the bytes they produce
+            auto match = output - offset;
+            if (offset >= matchLength)
+                std::memcpy(output, match, matchLength);
+            else
+                for (std::size_t i = 0; i < matchLength; i++)
+                    output[i] = match[i];
+            output += matchLength;
+        }
+
+        if (output != outputEnd) fail();
+    }
+
+    // Unity stores the 5 byte LZMA properties, followed by the raw stream without its size
+    void decompressLzma(const char* source, std::size_t sourceSize, char* target, std::size_t targetSize)
+    {
+#ifdef BDC_LZMA
+        if (sourceSize < LZMA_PROPS_SIZE) throw std::runtime_error("Corrupt LZMA block in bundle.");
+
+        lzma_filter filters[2] = { { LZMA_FILTER_LZMA1, nullptr }, { LZMA_VLI_UNKNOWN, nullptr } };
+        if (lzma_properties_decode(&filters[0], nullptr, reinterpret_cast<const uint8_t*>(source), LZMA_PROPS_SIZE) !=
+            LZMA_OK)
+            throw std::runtime_error("Corrupt LZMA block in bundle.");
+
+        lzma_stream stream = LZMA_STREAM_INIT;
+        auto result        = lzma_raw_decoder(&stream, filters);
+        std::free(filters[0].options);
+        if (result != LZMA_OK) throw std::runtime_error("Could not initialize LZMA decoder.");
+
+        stream.next_in   = reinterpret_cast<const uint8_t*>(source) + LZMA_PROPS_SIZE;
+        stream.avail_in  = sourceSize - LZMA_PROPS_SIZE;
+        stream.next_out  = reinterpret_cast<uint8_t*>(target);
+        stream.avail_out = targetSize;
+
+        while (result == LZMA_OK && stream.avail_out > 0 && stream.avail_in > 0)
+            result = lzma_code(&stream, LZMA_RUN);
+        lzma_end(&stream);
+
+        if ((result != LZMA_OK && result != LZMA_STREAM_END) || stream.avail_out != 0)
+            throw std::runtime_error("Corrupt LZMA block in bundle.");
+#else
+        throw std::runtime_error("LZMA compressed bundles require a build with liblzma.");
+#endif
+    }
+
+    void
+    decompressBlock(uint32_t flags, const char* source, std::size_t sourceSize, char* target, std::size_t targetSize)
+    {
+        switch (static_cast<BlockCompression>(flags & COMPRESSION_MASK))
+        {
+            case BlockCompression::NONE:
+                if (sourceSize != targetSize) throw std::runtime_error("Corrupt block in bundle.");
+                std::memcpy(target, source, sourceSize);
+                break;
+            case BlockCompression::LZMA: decompressLzma(source, sourceSize, target, targetSize); break;
+            case BlockCompression::LZ4:
+            case BlockCompression::LZ4HC: decompressLz4(source, sourceSize, target, targetSize); break;
+            default: throw std::runtime_error("Unsupported compression in bundle.");
+        }
+    }
+} // namespace
+
+/* Unity Bundle */
+UnityBundle::UnityBundle(const std::string& path)
+    : path(path)
+    , fileStream(path, std::ios::in | std::ios::binary)
+{
+    if (!fileStream) throw std::runtime_error("Could not open file: " + path);
+    if (readCString(fileStream) != "UnityFS") throw std::runtime_error("Not a UnityFS bundle: " + path);
+
+    auto version = readBigEndian<uint32_t>(fileStream);
+    readCString(fileStream); // Unity version
+    readCString(fileStream); // Unity revision
+    readBigEndian<int64_t>(fileStream); // file size
+    auto compressedInfoSize   = readBigEndian<uint32_t>(fileStream);
+    auto uncompressedInfoSize = readBigEndian<uint32_t>(fileStream);
+    auto flags                = readBigEndian<uint32_t>(fileStream);
+
+    uint64_t position = fileStream.tellg();
+    if (version >= 7) position = alignUp(position, 16);
+
+    std::vector<char> compressedInfo(compressedInfoSize);
+    if (flags & BLOCKS_INFO_AT_END)
+        fileStream.seekg(std::filesystem::file_size(path) - compressedInfoSize);
+    else
+    {
+        fileStream.seekg(position);
+        position += compressedInfoSize;
+    }
+    if (!fileStream.read(compressedInfo.data(), compressedInfoSize))
+        throw std::runtime_error("Unexpected end of bundle.");
+    if (flags & BLOCKS_INFO_NEEDS_PADDING) position = alignUp(position, 16);
+
+    std::vector<char> blocksInfo(uncompressedInfoSize);
+    decompressBlock(flags, compressedInfo.data(), compressedInfo.size(), blocksInfo.data(), blocksInfo.size());
+    readBlocksInfo(std::move(blocksInfo));
+
+    // blocks follow each other, both in the file and in the uncompressed data
+    for (auto& block : blocks)
+    {
+        block.fileOffset = position;
+        block.dataOffset = dataSize;
+        position += block.compressedSize;
+        dataSize += block.uncompressedSize;
+    }
+
+    for (auto& node : nodes)
+        if (node.flags & NODE_IS_SERIALIZED_FILE) indexSerializedFile(node);
+}
+
+void UnityBundle::readBlocksInfo(std::vector<char> blocksInfo)
+{
+    ByteCursor cursor(blocksInfo.data(), blocksInfo.size(), true);
+    cursor.skip(16); // hash of the uncompressed data
+
+    auto blockCount = cursor.read<int32_t>();
+    for (int32_t i = 0; i < blockCount; i++)
+    {
+        auto uncompressedSize = cursor.read<uint32_t>();
+        auto compressedSize   = cursor.read<uint32_t>();
+        auto flags            = cursor.read<uint16_t>();
+        blocks.push_back({ uncompressedSize, compressedSize, flags });
+    }
+
+    auto nodeCount = cursor.read<int32_t>();
+    for (int32_t i = 0; i < nodeCount; i++)
+    {
+        auto offset = cursor.read<uint64_t>();
+        auto size   = cursor.read<uint64_t>();
+        auto flags  = cursor.read<uint32_t>();
+        nodes.push_back({ offset, size, flags, std::string(cursor.readCString()) });
+    }
+}
+
+const char* UnityBundle::getBlockData(Block& block)
+{
+    if (block.data) return block.data.get();
+
+    compressed.resize(block.compressedSize);
+    fileStream.clear();
+    fileStream.seekg(block.fileOffset);
+    if (!fileStream.read(compressed.data(), block.compressedSize))
+        throw std::runtime_error("Unexpected end of bundle.");
+
+    auto data = std::make_unique_for_overwrite<char[]>(block.uncompressedSize);
+    decompressBlock(block.flags, compressed.data(), compressed.size(), data.get(), block.uncompressedSize);
+    block.data = std::move(data);
+
+    return block.data.get();
+}
+
+const char* UnityBundle::getData(uint64_t offset, uint64_t size)
+{
+    std::lock_guard lock(mutex);
+
+    if (size > dataSize || offset > dataSize - size) throw std::runtime_error("Corrupt bundle: " + path);
+    if (size == 0) return "";
+
+    auto first = std::partition_point(blocks.begin(),
+                                      blocks.end(),
+                                      [&](const Block& block)
+                                      { return block.dataOffset + block.uncompressedSize <= offset; });
+    if (offset + size <= first->dataOffset + first->uncompressedSize)
+        return getBlockData(*first) + (offset - first->dataOffset);
+
+    // ranges crossing blocks get copied together once
+    auto& span = spans[{ offset, size }];
+    if (span) return span.get();
+
+    auto buffer = std::make_unique_for_overwrite<char[]>(size);
+    for (uint64_t copied = 0; copied < size; first++)
+    {
+        auto start = offset + copied - first->dataOffset;
+        auto count = std::min<uint64_t>(first->uncompressedSize - start, size - copied);
+        std::memcpy(buffer.get() + copied, getBlockData(*first) + start, count);
+        copied += count;
+    }
+
+    span = std::move(buffer);
+    return span.get();
+}
+
+void UnityBundle::indexSerializedFile(const Node& node)
+{
+    ByteCursor header(getData(node.offset, SERIALIZED_HEADER_SIZE), SERIALIZED_HEADER_SIZE, true);
+    uint64_t metadataSize = header.read<uint32_t>();
+    header.read<uint32_t>(); // file size
+    auto version        = header.read<uint32_t>();
+    uint64_t dataOffset = header.read<uint32_t>();
+    bool isBigEndian    = header.read<uint8_t>() != 0;
+
+    if (version < 9) throw std::runtime_error("Unsupported serialized file version " + std::to_string(version));
+
+    uint64_t metadataStart = SERIALIZED_HEADER_SIZE;
+    if (version >= 22)
+    {
+        header = ByteCursor(getData(node.offset, SERIALIZED_HEADER_SIZE22), SERIALIZED_HEADER_SIZE22, true);
+        header.skip(SERIALIZED_HEADER_SIZE);
+        metadataSize = header.read<uint32_t>();
+        header.read<uint64_t>(); // file size
+        dataOffset    = header.read<uint64_t>();
+        metadataStart = SERIALIZED_HEADER_SIZE22;
+    }
+
+    // only the class of every object is needed, everything else gets skipped
+    auto metadataEnd = metadataStart + metadataSize;
+    ByteCursor cursor(getData(node.offset, metadataEnd), metadataEnd, isBigEndian);
+    cursor.skip(metadataStart);
+    cursor.readCString(); // Unity version
+    cursor.read<int32_t>(); // target platform
+    bool hasTypeTree = version >= 13 ? cursor.read<uint8_t>() != 0 : true;
+
+    std::vector<int32_t> classIds;
+    auto typeCount = cursor.read<int32_t>();
+    for (int32_t i = 0; i < typeCount; i++)
+    {
+        auto classId = cursor.read<int32_t>();
+        if (version >= 16) cursor.skip(1); // is stripped
+        if (version >= 17) cursor.skip(2); // script type index
+        if (version >= 13)
+        {
+            bool hasScriptId = version < 16 ? classId < 0 : classId == MONO_BEHAVIOUR_CLASS_ID;
+            cursor.skip(hasScriptId ? 32 : 16);
+        }
+
+        if (hasTypeTree)
+        {
+            if (version < 12 && version != 10)
+                throw std::runtime_error("Unsupported serialized file version " + std::to_string(version));
+
+            auto typeNodeCount = cursor.read<int32_t>();
+            auto stringSize    = cursor.read<int32_t>();
+            cursor.skip(static_cast<std::size_t>(typeNodeCount) * (version >= 19 ? 32 : 24) + stringSize);
+            if (version >= 21) cursor.skip(static_cast<std::size_t>(cursor.read<int32_t>()) * 4); // dependencies
+        }
+
+        classIds.push_back(classId);
+    }
+
+    bool hasBigIds = version < 14 && cursor.read<int32_t>() != 0;
+
+    std::vector<std::pair<uint64_t, uint64_t>> objects;
+    auto objectCount = cursor.read<int32_t>();
+    for (int32_t i = 0; i < objectCount; i++)
+    {
+        if (version >= 14) cursor.align(4);
+        cursor.skip(hasBigIds || version >= 14 ? 8 : 4); // path id
+
+        uint64_t start = version >= 22 ? cursor.read<uint64_t>() : cursor.read<uint32_t>();
+        uint64_t size  = cursor.read<uint32_t>();
+        auto typeId    = cursor.read<int32_t>();
+
+        int32_t classId = 0;
+        if (version < 16)
+            classId = cursor.read<uint16_t>();
+        else if (typeId >= 0 && static_cast<std::size_t>(typeId) < classIds.size())
+            classId = classIds[typeId];
+        if (version < 17) cursor.skip(2); // destroyed flag or script type index
+        if (version == 15 || version == 16) cursor.skip(1); // is stripped
+
+        if (classId == TEXT_ASSET_CLASS_ID) objects.emplace_back(node.offset + dataOffset + start, size);
+    }
+
+    // a TextAsset starts with its name, followed by its contents
+    for (auto [offset, size] : objects)
+    {
+        ByteCursor object(getData(offset, size), size, isBigEndian);
+        auto name = object.readBytes(object.read<int32_t>());
+        object.align(4);
+        auto contentSize = object.read<int32_t>();
+        object.skip(contentSize);
+
+        textAssets.emplace(name, TextAsset{ offset + object.getPosition() - contentSize, uint64_t(contentSize) });
+    }
+}
+
+bool UnityBundle::hasTextAsset(std::string_view name) const { return textAssets.find(name) != textAssets.end(); }
+
+std::string_view UnityBundle::getTextAsset(std::string_view name)
+{
+    auto it = textAssets.find(name);
+    if (it == textAssets.end()) throw std::runtime_error("Bundle has no TextAsset named " + std::string(name));
+
+    return { getData(it->second.offset, it->second.size), it->second.size };
+}
+
+std::shared_ptr<UnityBundle> openBundle(const std::string& path)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<UnityBundle>> bundles;
+
+    std::lock_guard lock(mutex);
+    auto& bundle = bundles[std::filesystem::absolute(path).string()];
+    if (!bundle) bundle = std::make_shared<UnityBundle>(path);
+
+    return bundle;
+}
+
+/* Bundle Asset Buffer */
+BundleAssetBuffer::BundleAssetBuffer(std::shared_ptr<UnityBundle> bundle, std::string_view name)
+    : bundle(bundle)
+{
+    auto contents = bundle->getTextAsset(name);
+    auto begin    = const_cast<char*>(contents.data());
+    setg(begin, begin, begin + contents.size());
+}
+
+BundleAssetBuffer::pos_type
+BundleAssetBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (dir == std::ios::cur) offset += gptr() - eback();
+    if (dir == std::ios::end) offset += egptr() - eback();
+
+    return seekpos(pos_type(offset), which);
+}
+
+BundleAssetBuffer::pos_type BundleAssetBuffer::seekpos(pos_type position, std::ios::openmode which)
+{
+    if (!(which & std::ios::in) || position < 0 || position > egptr() - eback()) return pos_type(off_type(-1));
+
+    setg(eback(), eback() + off_type(position), egptr());
+    return position;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+ * Read-only access to the TextAssets of a UnityFS asset bundle, like the ones in gamesystem/game/systemdata.
+ * Blocks are decompressed (LZ4, or LZMA when built with liblzma) when first needed: opening the bundle only reads the
+ * blocks holding the metadata and the name of every TextAsset, extracting one only those holding its contents.
+ * Thread-safe.
+ */
+class UnityBundle
+{
+    struct Block
+    {
+        uint32_t uncompressedSize;
+        uint32_t compressedSize;
+        uint16_t flags;
+        uint64_t fileOffset = 0;
+        uint64_t dataOffset = 0; // in the uncompressed data of the bundle
+        std::unique_ptr<char[]> data{};
+    };
+
+    struct Node
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t flags;
+        std::string path;
+    };
+
+    struct TextAsset
+    {
+        uint64_t offset; // of the contents, in the uncompressed data of the bundle
+        uint64_t size;
+    };
+
+    std::string path;
+    std::ifstream fileStream;
+    std::vector<Block> blocks{};
+    std::vector<Node> nodes{};
+    std::map<std::string, TextAsset, std::less<>> textAssets{};
+
+    uint64_t dataSize = 0;
+    // ranges crossing blocks, copied together by offset and size
+    std::map<std::pair<uint64_t, uint64_t>, std::unique_ptr<char[]>> spans{};
+    std::vector<char> compressed{};
+    std::mutex mutex;
+
+    void readBlocksInfo(std::vector<char> blocksInfo);
+    const char* getBlockData(Block& block);
+    const char* getData(uint64_t offset, uint64_t size);
+    void indexSerializedFile(const Node& node);
+
+public:
+    UnityBundle(const std::string& path);
+
+    UnityBundle(const UnityBundle&)            = delete;
+    UnityBundle& operator=(const UnityBundle&) = delete;
+
+    bool hasTextAsset(std::string_view name) const;
+
+    // decompresses the blocks of the asset if needed, the view stays valid for the lifetime of the bundle
+    std::string_view getTextAsset(std::string_view name);
+};
+
+/*
+ * Bundles stay open for the lifetime of the process, so every table extracted from a bundle shares one read of it.
+ */
+std::shared_ptr<UnityBundle> openBundle(const std::string& path);
+
+/*
+ * Input stream buffer over a TextAsset, keeping its bundle alive.
+ */
+class BundleAssetBuffer : public std::streambuf
+{
+    std::shared_ptr<UnityBundle> bundle;
+
+protected:
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    BundleAssetBuffer(std::shared_ptr<UnityBundle> bundle, std::string_view name);
+};
@@ -0,0 +1,429 @@
+#include "UringStream.hpp"
+
+#include <linux/io_uring.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* Uring */
+Uring::Uring(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0) throw std::runtime_error("io_uring is not available.");
+
+    sqRingSize     = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize     = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+    auto map = [&](std::size_t size, off_t offset)
+    {
+        auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+        if (ptr == MAP_FAILED)
+        {
+            release();
+            throw std::runtime_error("io_uring ring mapping failed.");
+        }
+        return ptr;
+    };
+
+    sqRing   = map(sqRingSize, IORING_OFF_SQ_RING);
+    cqRing   = singleMap ? sqRing : map(cqRingSize, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes     = static_cast<io_uring_sqe*>(map(sqesSize, IORING_OFF_SQES));
+
+    auto sq     = static_cast<char*>(sqRing);
+    sqHead      = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail      = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray     = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask      = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqEntries   = params.sq_entries;
+    sqLocalTail = *sqTail;
+
+    auto cq = static_cast<char*>(cqRing);
+    cqHead  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask  = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+Uring::~Uring() { release(); }
+
+void Uring::release()
+{
+    if (sqes) munmap(sqes, sqesSize);
+    if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+    if (sqRing) munmap(sqRing, sqRingSize);
+    if (ringFd >= 0) close(ringFd);
+
+    sqes   = nullptr;
+    cqRing = nullptr;
+    sqRing = nullptr;
+    ringFd = -1;
+}
+
+io_uring_sqe& Uring::getSqe()
+{
+    if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) submit();
+
+    auto index     = sqLocalTail & sqMask;
+    sqArray[index] = index;
+    sqLocalTail++;
+    unsubmitted++;
+
+    std::memset(&sqes[index], 0, sizeof(io_uring_sqe));
+    return sqes[index];
+}
+
+void Uring::submit(unsigned minComplete)
+{
+    __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+
+    unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (unsubmitted > 0 || minComplete > 0)
+    {
+        auto result = syscall(__NR_io_uring_enter, ringFd, unsubmitted, minComplete, flags, nullptr, 0);
+        if (result < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            throw std::runtime_error("io_uring_enter failed.");
+        }
+
+        unsubmitted -= static_cast<unsigned>(result);
+        break;
+    }
+}
+
+bool Uring::popCompletion(uint64_t& userData, int32_t& result)
+{
+    auto head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+
+    auto& cqe = cqes[head & cqMask];
+    userData  = cqe.user_data;
+    result    = cqe.res;
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool Uring::registerBuffers(std::vector<UringBlock>& blocks)
+{
+    std::vector<iovec> iovecs;
+    for (auto& block : blocks)
+        iovecs.push_back({ block.data.data(), block.data.size() });
+
+    // usually fails due to RLIMIT_MEMLOCK, plain reads/writes work just as well then
+    auto result = syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), iovecs.size());
+
+    hasFixedBuffers = result == 0;
+    return hasFixedBuffers;
+}
+
+bool Uring::usesFixedBuffers() const { return hasFixedBuffers; }
+
+/* Read Buffer */
+UringReadBuffer::UringReadBuffer(const std::string& path, std::size_t blockSize, std::size_t blockCount)
+    : ring(static_cast<unsigned>(blockCount * 2))
+    , blocks(blockCount)
+{
+    fileFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileFd < 0) throw std::runtime_error("Could not open file: " + path);
+
+    struct stat fileStat;
+    fstat(fileFd, &fileStat);
+    fileSize = fileStat.st_size;
+
+    for (auto& block : blocks)
+        block.data.resize(blockSize);
+
+    ring.registerBuffers(blocks);
+    restartAt(0);
+}
+
+UringReadBuffer::~UringReadBuffer()
+{
+    drain();
+    close(fileFd);
+}
+
+uint64_t UringReadBuffer::getPosition() const
+{
+    return blocks[current].offset + (eback() == nullptr ? 0 : gptr() - eback());
+}
+
+void UringReadBuffer::submitRead(std::size_t index)
+{
+    auto& block  = blocks[index];
+    block.offset = nextSubmitOffset;
+    block.length = static_cast<int32_t>(std::min<uint64_t>(block.data.size(), fileSize - nextSubmitOffset));
+    block.filled = 0;
+    block.error  = 0;
+    if (block.length == 0) return;
+
+    submitRemainder(index);
+    nextSubmitOffset += block.length;
+}
+
+void UringReadBuffer::submitRemainder(std::size_t index)
+{
+    auto& block   = blocks[index];
+    auto& sqe     = ring.getSqe();
+    sqe.opcode    = ring.usesFixedBuffers() ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe.fd        = fileFd;
+    sqe.addr      = reinterpret_cast<uint64_t>(block.data.data() + block.filled);
+    sqe.len       = block.length - block.filled;
+    sqe.off       = block.offset + block.filled;
+    sqe.buf_index = static_cast<uint16_t>(index);
+    sqe.user_data = index;
+
+    block.isInFlight = true;
+}
+
+void UringReadBuffer::completeNext()
+{
+    uint64_t completed;
+    int32_t result;
+    if (!ring.popCompletion(completed, result))
+    {
+        ring.submit(1);
+        return;
+    }
+
+    auto& block      = blocks[completed];
+    block.isInFlight = false;
+
+    // the file shrinking while it is read ends it early, just like a failed read
+    if (result <= 0)
+    {
+        block.error = result < 0 ? -result : EIO;
+        return;
+    }
+
+    // short reads are rare, but possible on network file systems
+    block.filled += result;
+    if (block.filled < block.length)
+    {
+        submitRemainder(completed);
+        ring.submit();
+    }
+}
+
+void UringReadBuffer::waitFor(std::size_t index)
+{
+    while (blocks[index].isInFlight)
+        completeNext();
+
+    auto& block = blocks[index];
+    if (block.error != 0)
+        throw std::runtime_error("Could not read file at offset " + std::to_string(block.offset + block.filled) +
+                                 ": " + std::strerror(block.error));
+}
+
+void UringReadBuffer::drain()
+{
+    // blocks being dropped don't report their errors, they only must not be written into anymore
+    for (auto& block : blocks)
+        while (block.isInFlight)
+            completeNext();
+}
+
+void UringReadBuffer::restartAt(uint64_t offset)
+{
+    drain();
+
+    nextSubmitOffset = std::min(offset, fileSize);
+    current          = 0;
+    for (std::size_t i = 0; i < blocks.size(); i++)
+        submitRead(i);
+    ring.submit();
+
+    blocks[current].offset = offset;
+    setg(nullptr, nullptr, nullptr);
+}
+
+UringReadBuffer::int_type UringReadBuffer::underflow()
+{
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    // the current block is fully consumed, queue it up for the data after the last submitted block
+    if (eback() != nullptr)
+    {
+        submitRead(current);
+        ring.submit();
+        current = (current + 1) % blocks.size();
+    }
+
+    waitFor(current);
+
+    auto& block = blocks[current];
+    auto data   = block.data.data();
+    setg(data, data, data + block.length);
+
+    if (block.length == 0) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+}
+
+UringReadBuffer::pos_type UringReadBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (!(which & std::ios::in)) return pos_type(off_type(-1));
+
+    uint64_t target = offset;
+    if (dir == std::ios::cur) target = getPosition() + offset;
+    if (dir == std::ios::end) target = fileSize + offset;
+
+    return seekpos(pos_type(target), which);
+}
+
+UringReadBuffer::pos_type UringReadBuffer::seekpos(pos_type position, std::ios::openmode which)
+{
+    if (!(which & std::ios::in) || position < 0) return pos_type(off_type(-1));
+
+    uint64_t target = static_cast<uint64_t>(off_type(position));
+    auto& block     = blocks[current];
+
+    // stay within the current block when possible, that keeps the read-ahead going
+    if (eback() != nullptr && target >= block.offset && target < block.offset + block.length)
+        setg(eback(), eback() + (target - block.offset), egptr());
+    else if (target != getPosition())
+        restartAt(target);
+
+    return position;
+}
+
+/* Write Buffer */
+UringWriteBuffer::UringWriteBuffer(const std::string& path, std::size_t blockSize, std::size_t blockCount)
+    : ring(static_cast<unsigned>(blockCount * 2))
+    , blocks(blockCount)
+{
+    fileFd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fileFd < 0) throw std::runtime_error("Could not open file: " + path);
+
+    for (auto& block : blocks)
+        block.data.resize(blockSize);
+
+    ring.registerBuffers(blocks);
+    setp(blocks[0].data.data(), blocks[0].data.data() + blockSize);
+}
+
+UringWriteBuffer::~UringWriteBuffer()
+{
+    sync();
+    close(fileFd);
+}
+
+void UringWriteBuffer::submitCurrent()
+{
+    auto length = static_cast<int32_t>(pptr() - pbase());
+    if (length == 0) return;
+
+    auto& block  = blocks[current];
+    block.offset = fileOffset;
+    block.length = length;
+
+    auto& sqe     = ring.getSqe();
+    sqe.opcode    = ring.usesFixedBuffers() ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd        = fileFd;
+    sqe.addr      = reinterpret_cast<uint64_t>(block.data.data());
+    sqe.len       = block.length;
+    sqe.off       = block.offset;
+    sqe.buf_index = static_cast<uint16_t>(current);
+    sqe.user_data = current;
+    ring.submit();
+
+    block.isInFlight = true;
+    fileOffset += length;
+
+    current    = (current + 1) % blocks.size();
+    auto& next = blocks[current];
+    waitFor(current);
+    setp(next.data.data(), next.data.data() + next.data.size());
+}
+
+void UringWriteBuffer::waitFor(std::size_t index)
+{
+    while (blocks[index].isInFlight)
+    {
+        uint64_t completed;
+        int32_t result;
+        if (!ring.popCompletion(completed, result))
+        {
+            ring.submit(1);
+            continue;
+        }
+
+        auto& block      = blocks[completed];
+        block.isInFlight = false;
+        if (result < 0)
+        {
+            hasError = true;
+            continue;
+        }
+
+        int32_t done = result;
+        while (done < block.length)
+        {
+            auto count = pwrite(fileFd, block.data.data() + done, block.length - done, block.offset + done);
+            if (count <= 0)
+            {
+                hasError = true;
+                break;
+            }
+            done += static_cast<int32_t>(count);
+        }
+    }
+}
+
+void UringWriteBuffer::drain()
+{
+    for (std::size_t i = 0; i < blocks.size(); i++)
+        waitFor(i);
+}
+
+UringWriteBuffer::int_type UringWriteBuffer::overflow(int_type ch)
+{
+    submitCurrent();
+    if (hasError) return traits_type::eof();
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+int UringWriteBuffer::sync()
+{
+    submitCurrent();
+    drain();
+    return hasError ? -1 : 0;
+}
+
+UringWriteBuffer::pos_type UringWriteBuffer::seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which)
+{
+    if (!(which & std::ios::out) || dir == std::ios::end) return pos_type(off_type(-1));
+    if (dir == std::ios::cur) offset += fileOffset + (pptr() - pbase());
+
+    return seekpos(pos_type(offset), which);
+}
+
+UringWriteBuffer::pos_type UringWriteBuffer::seekpos(pos_type position, std::ios::openmode which)
+{
+    if (!(which & std::ios::out) || position < 0) return pos_type(off_type(-1));
+    if (sync() != 0) return pos_type(off_type(-1));
+
+    fileOffset = static_cast<uint64_t>(off_type(position));
+    return position;
+}
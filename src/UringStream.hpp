@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+struct UringBlock
+{
+    std::vector<char> data;
+    uint64_t offset = 0;
+    int32_t length  = 0;
+    int32_t filled  = 0; // bytes read so far, short reads get resubmitted for the rest
+    int32_t error   = 0; // errno of a failed read
+    bool isInFlight = false;
+};
+
+/*
+ * Minimal io_uring wrapper using the raw syscalls, so there is no dependency on liburing.
+ * Throws when io_uring is not available (old kernel, seccomp, ...).
+ */
+class Uring
+{
+    int ringFd = -1;
+
+    void* sqRing           = nullptr;
+    void* cqRing           = nullptr;
+    std::size_t sqRingSize = 0;
+    std::size_t cqRingSize = 0;
+    io_uring_sqe* sqes     = nullptr;
+    std::size_t sqesSize   = 0;
+
+    unsigned* sqHead     = nullptr;
+    unsigned* sqTail     = nullptr;
+    unsigned* sqArray    = nullptr;
+    unsigned sqMask      = 0;
+    unsigned sqEntries   = 0;
+    unsigned sqLocalTail = 0;
+    unsigned* cqHead     = nullptr;
+    unsigned* cqTail     = nullptr;
+    unsigned cqMask      = 0;
+    io_uring_cqe* cqes   = nullptr;
+
+    unsigned unsubmitted = 0;
+    bool hasFixedBuffers = false;
+
+    void release();
+
+public:
+    Uring(unsigned entries);
+    ~Uring();
+
+    Uring(const Uring&)            = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    io_uring_sqe& getSqe();
+    void submit(unsigned minComplete = 0);
+    bool popCompletion(uint64_t& userData, int32_t& result);
+    bool registerBuffers(std::vector<UringBlock>& blocks);
+    bool usesFixedBuffers() const;
+};
+
+/*
+ * Read-ahead stream buffer. Keeps all but the currently consumed block in flight, so decoding overlaps with I/O.
+ */
+class UringReadBuffer : public std::streambuf
+{
+    Uring ring;
+    int fileFd        = -1;
+    uint64_t fileSize = 0;
+    std::vector<UringBlock> blocks;
+    std::size_t current       = 0;
+    uint64_t nextSubmitOffset = 0;
+
+    uint64_t getPosition() const;
+    void submitRead(std::size_t block);
+    void submitRemainder(std::size_t block);
+    void completeNext();
+    void waitFor(std::size_t block);
+    void drain();
+    void restartAt(uint64_t offset);
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    UringReadBuffer(const std::string& path, std::size_t blockSize, std::size_t blockCount);
+    ~UringReadBuffer();
+};
+
+/*
+ * Write-behind stream buffer. Full blocks are submitted and only waited on once they need to be reused.
+ */
+class UringWriteBuffer : public std::streambuf
+{
+    Uring ring;
+    int fileFd = -1;
+    std::vector<UringBlock> blocks;
+    std::size_t current = 0;
+    uint64_t fileOffset = 0;
+    bool hasError       = false;
+
+    void submitCurrent();
+    void waitFor(std::size_t block);
+    void drain();
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios::openmode which) override;
+
+public:
+    UringWriteBuffer(const std::string& path, std::size_t blockSize, std::size_t blockCount);
+    ~UringWriteBuffer();
+};
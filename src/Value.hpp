@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+using Value = std::variant<int8_t,
+                           int16_t,
+                           int32_t,
+                           uint8_t,
+                           uint16_t,
+                           uint32_t,
+                           float,
+                           double,
+                           std::pmr::string,
+                           std::pmr::vector<int32_t>,
+                           std::pmr::vector<uint32_t>,
+                           std::pmr::vector<float>,
+                           std::pmr::vector<double>>;
+
+// all values of a field in a table, strings and arrays being views into the memory of the table
+using Column = std::variant<std::vector<int8_t>,
+                            std::vector<int16_t>,
+                            std::vector<int32_t>,
+                            std::vector<uint8_t>,
+                            std::vector<uint16_t>,
+                            std::vector<uint32_t>,
+                            std::vector<float>,
+                            std::vector<double>,
+                            std::vector<std::string_view>,
+                            std::vector<std::span<const int32_t>>,
+                            std::vector<std::span<const uint32_t>>,
+                            std::vector<std::span<const float>>,
+                            std::vector<std::span<const double>>>;
+
+inline double toNumber(const Value& value)
+{
+    return std::visit(
+        [](auto& val) -> double
+        {
+            if constexpr (std::is_arithmetic_v<std::decay_t<decltype(val)>>)
+                return static_cast<double>(val);
+            else
+                throw std::runtime_error("Value is not numeric.");
+        },
+        value);
+}